@@ -1,5 +1,7 @@
 #pragma once
 
+#include <string>
+
 #include "deflatedbuffer.h"
 
 namespace avro {
@@ -7,6 +9,11 @@ namespace avro {
 struct Block {
     DeflatedBuffer buffer;
     int64_t objectCount = 0;
+    int64_t skipObjects = 0; // records before a seek position
+    size_t number = 0;
+    // a part of a split block starts from this record of the block
+    int64_t firstRecord = 0;
+    const std::string *fileName = nullptr;
 };
 
 }
\ No newline at end of file
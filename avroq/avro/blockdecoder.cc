@@ -3,8 +3,10 @@
 #include <filter/equality_expression.h>
 #include <filter/record_expression.h>
 
+#include "dumper/bloom.h"
 #include "dumper/fool.h"
 #include "dumper/json.h"
+#include "dumper/stats.h"
 #include "dumper/tsv.h"
 
 #include "node/all_nodes.h"
@@ -24,16 +26,25 @@
 
 namespace avro {
 
-BlockDecoder::BlockDecoder(const struct header &header, Limiter &limit) : header(header), limit(limit) {
+BlockDecoder::BlockDecoder(const struct header &header, Limiter &limit)
+    : header(header),
+      limit(limit),
+      flatSchema(*header.schema) {
 }
 
 
 void BlockDecoder::setFilter(std::unique_ptr<filter::Filter> flt) {
 
     predicates.reset(new predicate::List(std::move(flt), header.schema.get()));
+    requiredLiterals = predicates->requiredLiterals();
+
+    itemPredicates.clear();
+    for(uint32_t i = 0; i < flatSchema.size(); ++i) {
+        itemPredicates.push_back(predicates->getEqualRange(flatSchema[i].node));
+    }
 
     if (parseLoopEnabled) {
-        compileFilteringParser(parseLoop, header.schema);
+        parseLoop = compileFilter();
     }
 
 }
@@ -42,7 +53,7 @@ void BlockDecoder::setTsvFilterExpression(const dumper::TsvExpression &tsvFields
     this->tsvFieldsList = tsvFieldsList;
 
     if (parseLoopEnabled) {
-        compileTsvExpression(tsvDumpLoop, header.schema);
+        tsvDumpLoop = compileTsvExpression();
     }
 }
 
@@ -62,6 +73,10 @@ void BlockDecoder::enableParseLoop() {
     parseLoopEnabled = true;
 }
 
+void BlockDecoder::enablePrintPosition() {
+    printPosition = true;
+}
+
 void BlockDecoder::outputAsJson(bool pretty) {
     jsonMode = true;
     if (pretty) {
@@ -74,34 +89,42 @@ void BlockDecoder::decodeAndDumpBlock(Block &block) {
 
     if (countOnly && !predicates) {
         // TODO: count without decompression
-        coutMethod(block.objectCount);
+        coutMethod(std::max<int64_t>(0, block.objectCount - block.skipObjects));
         return;
     }
 
+    for(const auto &literal : requiredLiterals) {
+        if (!block.buffer.mayContain(literal)) {
+            return;
+        }
+    }
+
     for(int i = 0; i < block.objectCount ; ++i) {
         // TODO: rewrite it using hierarcy of filters/decoders.
         // TODO: implement counter as a filter  
         if (limit.finished()) {
             throw Finished();
         }
+        block.buffer.fillWindow();
         if (block.buffer.eof()) {
             throw Eof();
         }
         block.buffer.startDocument();
         //std::cout << i << " out of << " << block.objectCount << std::endl;
-        if (parseLoopEnabled) {
-            for(size_t i = 0; i < parseLoop.size(); ) {
-                i += parseLoop[i](block.buffer);
+        if (i < block.skipObjects) {
+            filterDocument(block.buffer, false);
+            if (predicates) {
+                predicates->resetState();
             }
-        } else {
-            decodeDocument(block.buffer, header.schema);
+            continue;
         }
+        filterDocument(block.buffer, parseLoopEnabled);
 
         if (!predicates || predicates->expressionPassed()) {
 
             limit.documentFinished();
 
-            dumpDocument(block);
+            dumpDocument(block, i);
 
         }
         if(predicates) {
@@ -111,99 +134,193 @@ void BlockDecoder::decodeAndDumpBlock(Block &block) {
 
 }
 
-void BlockDecoder::dumpDocument(Block &block) {
+void BlockDecoder::filterDocument(DeflatedBuffer &stream, bool useParseLoop) {
+    while (true) {
+        if (useParseLoop) {
+            runProgram(parseLoop, stream);
+        } else {
+            if (predicates) {
+                decodeDocument(stream, 0);
+            } else {
+                skipDocument(stream, 0);
+            }
+        }
+
+        if (!stream.eof() || !stream.growWindow()) {
+            break;
+        }
+        // record didn't fit into the window
+        stream.resetToDocument();
+        if (predicates) {
+            predicates->resetState();
+        }
+    }
+}
+
+void BlockDecoder::collectStats(Block &block, sidecar::BlockStats &stats) {
+    stats.objectCount = block.objectCount;
+    dumper::Stats dumper(tsvFieldsList, stats);
+    dumpBlock(block, dumper);
+}
+
+void BlockDecoder::collectBloom(Block &block, sidecar::BlockBloom &bloom) {
+    dumper::Bloom dumper(tsvFieldsList, bloom, block.objectCount);
+    dumpBlock(block, dumper);
+}
+
+std::vector<size_t> BlockDecoder::findRecords(Block &block, size_t every) {
+    if (skipLoop.empty()) {
+        skipLoop = compileFilter();
+    }
+
+    std::vector<size_t> offsets;
+    for(int64_t i = 0; i < block.objectCount; ++i) {
+        if (i % every == 0) {
+            offsets.push_back(block.buffer.position());
+        }
+        runProgram(skipLoop, block.buffer);
+        if (block.buffer.eof()) {
+            throw std::runtime_error("Block " + std::to_string(block.number) +
+                                     " is shorter than its " + std::to_string(block.objectCount) + " records");
+        }
+    }
+    offsets.push_back(block.buffer.position());
+    return offsets;
+}
+
+template <class T>
+void BlockDecoder::dumpBlock(Block &block, T &dumper) {
+    for(int i = 0; i < block.objectCount ; ++i) {
+        if (block.buffer.eof()) {
+            throw Eof();
+        }
+        block.buffer.startDocument();
+        dumpDocument(block.buffer, 0, dumper);
+    }
+}
+
+void BlockDecoder::dumpDocument(Block &block, int64_t record) {
     if (countOnly) {
         coutMethod(1);
         return;
     }
+
+    std::function<void(const std::string &)> dumpWithPosition;
+    if (printPosition) {
+        const std::string position = *block.fileName + "\t" +
+            std::to_string(block.number) + "\t" + std::to_string(block.firstRecord + record) + "\t";
+        dumpWithPosition = [this, position](const std::string &document) {
+            dumpMethod(position + document);
+        };
+    }
+    const auto &dump = printPosition ? dumpWithPosition : dumpMethod;
+
     /*void _dump_deb();
     _dump_deb();
     std::cout << "===================\n";*/
-    block.buffer.resetToDocument();
-    if (tsvFieldsList.pos > 0) {
-        dumper::Tsv dumper(tsvFieldsList);
-        if (parseLoopEnabled) {
-            for(size_t i = 0; i < tsvDumpLoop.size(); ) {
-                // std::cout << "i=" << i << std::endl;
-                i += tsvDumpLoop[i](block.buffer, dumper);
+    // filter may read only a part of the record: a streamed record cut by
+    // the end of the window is dumped again once the window is grown
+    auto cut = [&block]() {
+        return block.buffer.eof() && block.buffer.growWindow();
+    };
+
+    while (true) {
+        block.buffer.resetToDocument();
+        if (tsvFieldsList.pos > 0) {
+            dumper::Tsv dumper(tsvFieldsList);
+            if (parseLoopEnabled) {
+                runProgram(tsvDumpLoop, block.buffer, &dumper);
+            } else {
+                dumpDocument(block.buffer, 0, dumper);
+            }
+            if (cut()) {
+                continue;
+            }
+            dumper.EndDocument(dump);
+        } else if (jsonMode) {
+            if (jsonPrettyMode) {
+                dumper::Json<dumper::JsonTag::pretty> dumper;
+                dumpDocument(block.buffer, 0, dumper);
+                if (cut()) {
+                    continue;
+                }
+                dumper.EndDocument(dump);
+            } else {
+                dumper::Json<dumper::JsonTag::plain> dumper;
+                dumpDocument(block.buffer, 0, dumper);
+                if (cut()) {
+                    continue;
+                }
+                dumper.EndDocument(dump);
             }
         } else {
-            dumpDocument(block.buffer, header.schema, dumper);
-        }
-        dumper.EndDocument(dumpMethod);
-    } else if (jsonMode) {
-        if (jsonPrettyMode) {
-            dumper::Json<dumper::JsonTag::pretty> dumper;
-            dumpDocument(block.buffer, header.schema, dumper);
-            dumper.EndDocument(dumpMethod);
-        } else {
-            dumper::Json<dumper::JsonTag::plain> dumper;
-            dumpDocument(block.buffer, header.schema, dumper);
-            dumper.EndDocument(dumpMethod);
+            dumper::Fool dumper;
+            dumpDocument(block.buffer, 0, dumper);
+            if (cut()) {
+                continue;
+            }
+            dumper.EndDocument(dump);
         }
-    } else {
-        dumper::Fool dumper;
-        dumpDocument(block.buffer, header.schema, dumper);
-        dumper.EndDocument(dumpMethod);
+        break;
     }
 
     // std::cout.flush();
 }
 
 
-void BlockDecoder::decodeDocument(DeflatedBuffer &stream, const std::unique_ptr<node::Node> &schema) {
-    if (schema->is<node::Record>()) {
-        for(auto &p : schema->as<node::Record>().getChildren()) {
-            decodeDocument(stream, p);
-        }
-        if (predicates) {
-            auto range = predicates->getEqualRange(schema.get());
-            if (range.first != range.second) {
-                for_each (
-                    range.first,
-                    range.second,
-                    [](const auto& filterItem){
-                        filterItem.second->recordEnd();
-                    }
-                );
-            }
-        }
-    } else if (schema->is<node::Union>()) {
-        int item = TypeParser<int>::read(stream);
-        const auto &node = schema->as<node::Union>().getChildren()[item];
-        decodeDocument(stream, node);
+void BlockDecoder::decodeDocument(DeflatedBuffer &stream, uint32_t index) {
+    using Type = node::FlatSchema::Type;
 
-        if (predicates) {
-            auto range = predicates->getEqualRange(schema.get());
-            if (range.first != range.second) {
-                for_each (
-                    range.first,
-                    range.second,
-                    [&node](const auto& filterItem){
-                        filterItem.second->setIsNull(node->is<node::Null>());
-                    }
-                );
+    const auto &item = flatSchema[index];
+    switch (item.type) {
+        case Type::RECORD: {
+            for(uint32_t i = 0; i < item.childCount; ++i) {
+                decodeDocument(stream, flatSchema.child(item, i));
             }
+            const auto &range = itemPredicates[index];
+            for_each (
+                range.first,
+                range.second,
+                [](const auto& filterItem){
+                    filterItem.second->recordEnd();
+                }
+            );
+            break;
         }
+        case Type::UNION: {
+            const uint32_t branch = flatSchema.child(item, unionBranch(stream, item));
+            decodeDocument(stream, branch);
 
-    } else if (schema->is<node::Custom>()) {
-        decodeDocument(stream, schema->as<node::Custom>().getDefinition());
-    } else if (schema->is<node::Enum>()) {
-        skipOrApplyFilter<int>(stream, schema);
-    } else if (schema->is<node::Array>()) {
-        auto const &node = schema->as<node::Array>().getItemsType();
+            const auto &range = itemPredicates[index];
+            const bool isNull = flatSchema[branch].type == Type::NULL_;
+            for_each (
+                range.first,
+                range.second,
+                [isNull](const auto& filterItem){
+                    filterItem.second->setIsNull(isNull);
+                }
+            );
+            break;
+        }
+        case Type::CUSTOM:
+            decodeDocument(stream, flatSchema.child(item, 0));
+            break;
+        case Type::ARRAY: {
+            const uint32_t items = flatSchema.child(item, 0);
+
+            const auto &range = itemPredicates[index];
+            // elements of an array without predicates are not looked at
+            if (range.first == range.second) {
+                skipDocument(stream, index);
+                break;
+            }
 
-        int objectsInBlock = 0;
-        do {
-            objectsInBlock = TypeParser<int>::read(stream);
+            int64_t objectsInBlock = 0;
+            do {
+                objectsInBlock = readItemsCount(stream);
 
-            decltype(predicates->getEqualRange(schema.get())) range;
-            if (predicates) {
-                range = predicates->getEqualRange(schema.get());
-            }
-            for(int i = 0; i < objectsInBlock; ++i) {
-                decodeDocument(stream, node);
-                if (range.first != range.second) {
+                for(int64_t i = 0; i < objectsInBlock && !stream.eof(); ++i) {
+                    decodeDocument(stream, items);
                     for_each (
                         range.first, range.second,
                         [](const auto& filterItem){
@@ -211,839 +328,628 @@ void BlockDecoder::decodeDocument(DeflatedBuffer &stream, const std::unique_ptr<
                         }
                     );
                 }
-            }
-        } while(objectsInBlock != 0);
-
-    } else if (schema->is<node::Map>()) {
-        auto const &node = schema->as<node::Map>().getItemsType();
-
-        int objectsInBlock = 0;
-        do {
-            objectsInBlock = TypeParser<int>::read(stream);
-
-            for(int i = 0; i < objectsInBlock; ++i) {
-                TypeParser<StringBuffer>::skip(stream);
-                decodeDocument(stream, node);
-            }
-        } while(objectsInBlock != 0);
-    } else {
-        if (schema->is<node::String>()) {
-            skipOrApplyFilter<StringBuffer>(stream, schema);
-        } else if (schema->is<node::Int>()) {
-            skipOrApplyFilter<int>(stream, schema);
-        } else if (schema->is<node::Long>()) {
-            skipOrApplyFilter<long>(stream, schema);
-        } else if (schema->is<node::Float>()) {
-            skipOrApplyFilter<float>(stream, schema);
-        } else if (schema->is<node::Double>()) {
-            skipOrApplyFilter<double>(stream, schema);
-        } else if (schema->is<node::Boolean>()) {
-            skipOrApplyFilter<bool>(stream, schema);
-        } else if (schema->is<node::Null>()) {
-            ; // empty value: no way to process
-        } else {
-            std::cerr << schema->getItemName() << ":" << schema->getTypeName() << std::endl;
-            std::cerr << "Can't read type: no decoder. Finishing." << std::endl;
-            throw Eof();
+            } while(objectsInBlock != 0);
+            break;
         }
+        case Type::MAP:
+            // maps are not filtered
+            skipDocument(stream, index);
+            break;
+        case Type::ENUM:
+            skipOrApplyFilter<int>(stream, index);
+            break;
+        case Type::STRING:
+            skipOrApplyFilter<StringBuffer>(stream, index);
+            break;
+        case Type::INT:
+            skipOrApplyFilter<int>(stream, index);
+            break;
+        case Type::LONG:
+            skipOrApplyFilter<long>(stream, index);
+            break;
+        case Type::FLOAT:
+            skipOrApplyFilter<float>(stream, index);
+            break;
+        case Type::DOUBLE:
+            skipOrApplyFilter<double>(stream, index);
+            break;
+        case Type::BOOLEAN:
+            skipOrApplyFilter<bool>(stream, index);
+            break;
+        case Type::NULL_:
+            ; // empty value: no way to process
+            break;
     }
 }
 
+void BlockDecoder::skipDocument(DeflatedBuffer &stream, uint32_t index) {
+    using Type = node::FlatSchema::Type;
 
-using parse_func_t = std::function<int(DeflatedBuffer &)>;
-
-std::vector<parse_func_t> parse_items;
-
-class ApplyUnion {
-public:
-    explicit ApplyUnion(
-                    int ret,
-                    predicate::List::filter_items_t::iterator start,
-                    predicate::List::filter_items_t::iterator end,
-                    int nullIndex,
-                    std::vector<int> &skipping)
-        : ret(ret),
-          start(start),
-          end(end),
-          nullIndex(nullIndex),
-          skipping(skipping) {
+    const auto &item = flatSchema[index];
+    if (item.fixedSize != node::FlatSchema::VARIABLE) {
+        stream.skip(item.fixedSize);
+        return;
     }
-    int operator() (DeflatedBuffer &stream) {
-        const auto &value = TypeParser<int>::read(stream);
-        for_each (
-            start, end,
-            [&value, this](const auto& filterItem){
-                filterItem.second->setIsNull(value == this->nullIndex);
+    switch (item.type) {
+        case Type::RECORD:
+            for(uint32_t i = 0; i < item.childCount; ++i) {
+                skipDocument(stream, flatSchema.child(item, i));
             }
-        );
-        return skipping[value];
-    }
-private:
-    int ret;
-    predicate::List::filter_items_t::iterator start;
-    predicate::List::filter_items_t::iterator end;
-    int nullIndex;
-    std::vector<int> skipping;
-};
-
-class JumpToN {
-public:
-    JumpToN(int ret, int nullIndex, std::vector<int> &skipping)
-        : skipping(skipping) {
-        (void)nullIndex;
-    }
-    int operator() (DeflatedBuffer &stream) {
-        int i = TypeParser<int>::read(stream);
-        return skipping[i];
-    }
-private:
-    std::vector<int> skipping;
-};
+            break;
+        case Type::UNION:
+            skipDocument(stream, flatSchema.child(item, unionBranch(stream, item)));
+            break;
+        case Type::CUSTOM:
+            skipDocument(stream, flatSchema.child(item, 0));
+            break;
+        case Type::ARRAY: {
+            const uint32_t items = flatSchema.child(item, 0);
+            const int32_t size = flatSchema[items].fixedSize;
+
+            int64_t objectsInBlock = 0;
+            do {
+                objectsInBlock = skipSizedItems(stream);
+                if (size != node::FlatSchema::VARIABLE) {
+                    stream.skip(objectsInBlock * size);
+                    continue;
+                }
+                for(int64_t i = 0; i < objectsInBlock && !stream.eof(); ++i) {
+                    skipDocument(stream, items);
+                }
+            } while(objectsInBlock != 0 && !stream.eof());
+            break;
+        }
+        case Type::MAP: {
+            const uint32_t values = flatSchema.child(item, 0);
 
-class SkipInt {
-public:
-    explicit SkipInt(int ret):ret(ret) {
-    }
-    int operator() (DeflatedBuffer &stream) {
-        TypeParser<int>::skip(stream);
-        return ret;
-    }
-private:
-    int ret;
-};
+            int64_t objectsInBlock = 0;
+            do {
+                objectsInBlock = skipSizedItems(stream);
 
-class SkipString {
-public:
-    explicit SkipString(int ret):ret(ret) {
-    }
-    int operator() (DeflatedBuffer &stream) {
-        TypeParser<StringBuffer>::skip(stream);
-        return ret;
-    }
-private:
-    int ret;
-};
-
-class ApplyString {
-public:
-    explicit ApplyString(int ret, predicate::List::filter_items_t::iterator start, predicate::List::filter_items_t::iterator end)
-        : ret(ret),
-          start(start),
-          end(end) {
-    }
-    int operator() (DeflatedBuffer &stream) {
-        const auto &value = TypeParser<StringBuffer>::read(stream);
-        for_each (
-            start, end,
-            [&value](const auto& filterItem){
-                filterItem.second->template apply<StringBuffer>(value);
-            }
-        );
-        return ret;
+                for(int64_t i = 0; i < objectsInBlock && !stream.eof(); ++i) {
+                    TypeParser<StringBuffer>::skip(stream);
+                    skipDocument(stream, values);
+                }
+            } while(objectsInBlock != 0);
+            break;
+        }
+        case Type::STRING:
+            TypeParser<StringBuffer>::skip(stream);
+            break;
+        case Type::ENUM:
+        case Type::INT:
+        case Type::LONG:
+            TypeParser<long>::skip(stream);
+            break;
+        default:
+            // fixed size types are skipped above
+            break;
     }
-private:
-    int ret;
-    predicate::List::filter_items_t::iterator start;
-    predicate::List::filter_items_t::iterator end;
-};
+}
 
-template <typename T>
-class Apply {
-public:
-    explicit Apply(int ret, predicate::List::filter_items_t::iterator start, predicate::List::filter_items_t::iterator end)
-        : ret(ret),
-          start(start),
-          end(end) {
-    }
-    int operator() (DeflatedBuffer &stream) {
-        const auto &value = TypeParser<T>::read(stream);
-        for_each (
-            start, end,
-            [&value](const auto& filterItem){
-                filterItem.second->template apply<T>(value);
-            }
-        );
-        return ret;
+uint32_t BlockDecoder::unionBranch(DeflatedBuffer &stream, const node::FlatSchema::Item &item) {
+    const int64_t branch = TypeParser<long>::read(stream);
+    if (branch < 0 || branch >= int64_t(item.childCount)) {
+        throw std::runtime_error("Invalid union index " + std::to_string(branch) +
+                                 " of '" + item.node->getItemName() + "'");
     }
-private:
-    int ret;
-    predicate::List::filter_items_t::iterator start;
-    predicate::List::filter_items_t::iterator end;
-};
+    return branch;
+}
 
 
-template <int n>
-class SkipNBytes {
-public:
-    explicit SkipNBytes(int ret):ret(ret) {
-    }
-    int operator() (DeflatedBuffer &stream) {
-        stream.skip(n);
-        return ret;
-    }
-    int operator() (DeflatedBuffer &stream, dumper::Tsv &tsv) {
-        (void)tsv;
-        return operator() (stream);
-    }
-private:
-    int ret;
-};
+ParseProgram BlockDecoder::compileFilter() {
+    ParseProgram program;
+    compileFilter(program, 0);
+    program.emit({ParseProgram::END});
+    return program;
+}
 
+void BlockDecoder::compileFilter(ParseProgram &program, uint32_t index) {
+    using Type = node::FlatSchema::Type;
 
-class SkipArray {
-public:
-    explicit SkipArray(int ret, BlockDecoder::const_node_t &schema, BlockDecoder &decoder)
-        : ret(ret),
-          nodeType(schema),
-          decoder(decoder) {
-    }
-    int operator() (DeflatedBuffer &stream) {
+    const auto &item = flatSchema[index];
 
-        int objectsInBlock = 0;
-        do {
-            objectsInBlock = TypeParser<int>::read(stream);
-            for(int i = 0; i < objectsInBlock; ++i) {
-                decoder.decodeDocument(stream, nodeType);
-            }
-        } while(objectsInBlock != 0);
-        return ret;
-    }
-    int operator() (DeflatedBuffer &stream, dumper::Tsv &tsv) {
-        (void)tsv;
-        return operator() (stream);
-    }
-private:
-    int ret;
-    BlockDecoder::const_node_t &nodeType;
-    BlockDecoder &decoder;
-};
-
-
-class ApplyArray {
-public:
-
-    explicit ApplyArray(int ret,
-        predicate::List::filter_items_t::iterator start,
-        predicate::List::filter_items_t::iterator end,
-        BlockDecoder::const_node_t &schema,
-        BlockDecoder &decoder)
-        : ret(ret),
-          nodeType(schema),
-          decoder(decoder),
-          start(start),
-          end(end) {
+    ParseProgram::predicates_t range;
+    if (predicates) {
+        range = itemPredicates[index];
     }
-    int operator() (DeflatedBuffer &stream) {
+    const bool filtered = range.first != range.second;
 
-        int objectsInBlock = 0;
-        do {
-            objectsInBlock = TypeParser<int>::read(stream);
-            for(int i = 0; i < objectsInBlock; ++i) {
-                decoder.decodeDocument(stream, nodeType);
-                for_each (
-                    start, end,
-                    [](const auto& filterItem){
-                        filterItem.second->pushArrayState();
+    // instruction of a scalar: applies predicates or skips the value
+    auto scalar = [this, &program, &range, filtered, index](ParseProgram::Op apply) {
+        if (filtered) {
+            program.emit({apply, program.addPredicates(range)});
+        } else {
+            compileSkip(program, index);
+        }
+    };
+
+    switch (item.type) {
+        case Type::RECORD:
+            for(uint32_t i = 0; i < item.childCount; ++i) {
+                compileFilter(program, flatSchema.child(item, i));
+            }
+            if (filtered) {
+                program.emit({ParseProgram::RECORD_END, program.addPredicates(range)});
+            }
+            break;
+        case Type::UNION: {
+            size_t targets;
+            if (filtered) {
+                uint32_t nullBranch = -1;
+                for(uint32_t i = 0; i < item.childCount; ++i) {
+                    if (flatSchema[flatSchema.child(item, i)].type == Type::NULL_) {
+                        nullBranch = i;
                     }
-                );
+                }
+                targets = program.emit({ParseProgram::UNION_APPLY, program.addPredicates(range), nullBranch, item.childCount}) + 4;
+            } else {
+                targets = program.emit({ParseProgram::UNION, item.childCount}) + 2;
             }
-        } while(objectsInBlock != 0);
-        return ret;
-    }
-    int operator() (DeflatedBuffer &stream, dumper::Tsv &tsv) {
-        (void)tsv;
-        return operator() (stream);
-    }
-private:
-    int ret;
-    BlockDecoder::const_node_t &nodeType;
-    BlockDecoder &decoder;
-    predicate::List::filter_items_t::iterator start;
-    predicate::List::filter_items_t::iterator end;
-};
-
-
-
-class ApplyRecord {
-public:
-
-    explicit ApplyRecord(int ret,
-        predicate::List::filter_items_t::iterator start,
-        predicate::List::filter_items_t::iterator end)
-        : ret(ret),
-          start(start),
-          end(end) {
-    }
-    int operator() (DeflatedBuffer &stream) {
-
-        for_each (
-            start, end,
-            [](const auto& filterItem){
-                filterItem.second->recordEnd();
+            program.code.resize(program.code.size() + item.childCount);
+
+            std::vector<size_t> jumps;
+            for(uint32_t i = 0; i < item.childCount; ++i) {
+                program.code[targets + i] = program.label();
+                compileFilter(program, flatSchema.child(item, i));
+                if (i + 1 < item.childCount) {
+                    jumps.push_back(program.emit({ParseProgram::JUMP, 0}));
+                }
             }
-        );
-        return ret;
-    }
-    int operator() (DeflatedBuffer &stream, dumper::Tsv &tsv) {
-        (void)tsv;
-        return operator() (stream);
-    }
-private:
-    int ret;
-    predicate::List::filter_items_t::iterator start;
-    predicate::List::filter_items_t::iterator end;
-};
-
-
-class SkipMap {
-public:
-    explicit SkipMap(int ret, BlockDecoder::const_node_t &schema, BlockDecoder &decoder)
-        : ret(ret),
-          nodeType(schema),
-          decoder(decoder) {
-    }
-    int operator() (DeflatedBuffer &stream) {
-
-        int objectsInBlock = 0;
-        do {
-            objectsInBlock = TypeParser<int>::read(stream);
-
-            for(int i = 0; i < objectsInBlock; ++i) {
-                TypeParser<StringBuffer>::skip(stream);
-                decoder.decodeDocument(stream, nodeType);
+            for(auto jump : jumps) {
+                program.code[jump + 1] = program.label();
             }
-        } while(objectsInBlock != 0);
-        return ret;
-    }
-    int operator() (DeflatedBuffer &stream, dumper::Tsv &tsv) {
-        (void)tsv;
-        return operator() (stream);
+            break;
+        }
+        case Type::CUSTOM:
+            compileFilter(program, flatSchema.child(item, 0));
+            break;
+        case Type::ARRAY:
+            if (filtered) {
+                program.emit({ParseProgram::APPLY_ARRAY, program.addPredicates(range), flatSchema.child(item, 0)});
+            } else {
+                compileSkip(program, index);
+            }
+            break;
+        case Type::MAP:
+            compileSkip(program, index);
+            break;
+        case Type::STRING:
+            scalar(ParseProgram::APPLY_STRING);
+            break;
+        case Type::ENUM:
+        case Type::INT:
+        case Type::LONG:
+            scalar(ParseProgram::APPLY_INT);
+            break;
+        case Type::FLOAT:
+            scalar(ParseProgram::APPLY_FLOAT);
+            break;
+        case Type::DOUBLE:
+            scalar(ParseProgram::APPLY_DOUBLE);
+            break;
+        case Type::BOOLEAN:
+            scalar(ParseProgram::APPLY_BOOLEAN);
+            break;
+        case Type::NULL_:
+            ; // empty value
+            break;
     }
-private:
-    int ret;
-    BlockDecoder::const_node_t &nodeType;
-    BlockDecoder &decoder;
-};
+}
 
+void BlockDecoder::compileSkip(ParseProgram &program, uint32_t index) {
+    using Type = node::FlatSchema::Type;
 
-int BlockDecoder::compileFilteringParser(std::vector<parse_func_t> &parse_items, const std::unique_ptr<node::Node> &schema, int elementsToSkip) {
+    const auto &item = flatSchema[index];
 
-    if (schema->is<node::Union>()) {
+    if (item.fixedSize != node::FlatSchema::VARIABLE) {
+        program.skipBytes(item.fixedSize);
+        return;
+    }
+    switch (item.type) {
+        case Type::STRING:
+            program.emit({ParseProgram::SKIP_STRING});
+            break;
+        case Type::ENUM:
+        case Type::INT:
+        case Type::LONG:
+            program.skipVarints(1);
+            break;
+        default:
+            program.emit({ParseProgram::SKIP_VALUE, index});
+            break;
+    }
+}
 
-        const auto &u = schema->as<node::Union>();
+ParseProgram BlockDecoder::compileTsvExpression() {
+    ParseProgram program;
+    compileTsvExpression(program, 0);
+    program.emit({ParseProgram::END});
+    return program;
+}
 
-        size_t nullIndex = -1;
+void BlockDecoder::compileTsvExpression(ParseProgram &program, uint32_t index) {
+    using Type = node::FlatSchema::Type;
 
-        auto size = u.getChildren().size();
+    const auto &item = flatSchema[index];
 
-        auto &children = u.getChildren();
-        int i = size;
+    const ParseProgram::fields_t range = tsvFieldsList.columnsOf(item.node->getNumber());
+    const bool printed = range.first != range.second;
 
-        std::vector<int> skipping;
-        int elementsLeft = elementsToSkip;
-        for(auto c = children.rbegin(); c != children.rend(); ++c) {
-            --i;
-            auto &p = *c;
-            if (p->is<node::Null>()) {
-                nullIndex = i;
-            }
-            elementsLeft += compileFilteringParser(parse_items, p, elementsLeft);
-            skipping.push_back(elementsLeft - elementsToSkip);
+    auto scalar = [this, &program, &range, printed, index](ParseProgram::Op print) {
+        if (printed) {
+            program.emit({print, program.addFields(range)});
+        } else {
+            compileSkip(program, index);
         }
-
-        skipOrApplyCompileFilter<JumpToN, ApplyUnion>(parse_items, schema, elementsToSkip, nullIndex, skipping);
-
-        return elementsLeft;
-    } else if (schema->is<node::Custom>()) {
-        return compileFilteringParser(parse_items, schema->as<node::Custom>().getDefinition());
-    } else if (schema->is<node::Record>()) {
-            if (predicates) {
-                auto range = predicates->getEqualRange(schema.get());
-                if (range.first != range.second) {
-                    auto it = parse_items.begin();
-                    parse_items.emplace(it, ApplyRecord(elementsToSkip, range.first, range.second));
-                }
+    };
+    // definition of a Custom is printed without the Custom's name
+    auto json = [this, &program, &range, &item]() {
+        program.emit({ParseProgram::TSV_JSON, program.addFields(range), flatSchema.indexOf(item.node)});
+    };
+
+    switch (item.type) {
+        case Type::RECORD:
+            if (printed) {
+                json();
+                break;
             }
-        auto &children = schema->as<node::Record>().getChildren();
-        size_t size = 1;
-        for(auto c = children.rbegin(); c != children.rend(); ++c) {
-            size += compileFilteringParser(parse_items, *c);
-        }
-        return size;
-    } else if (schema->is<node::Array>()) {
-
-            auto it = parse_items.begin();
-            if (predicates) {
-                auto range = predicates->getEqualRange(schema.get());
-                if (range.first != range.second) {
-                    parse_items.emplace(it, ApplyArray(elementsToSkip, range.first, range.second, schema->as<node::Array>().getItemsType(), *this));
-                    return 1;
+            for(uint32_t i = 0; i < item.childCount; ++i) {
+                compileTsvExpression(program, flatSchema.child(item, i));
+            }
+            break;
+        case Type::UNION: {
+            const size_t targets = program.emit({ParseProgram::UNION, item.childCount}) + 2;
+            program.code.resize(program.code.size() + item.childCount);
+
+            std::vector<size_t> jumps;
+            for(uint32_t i = 0; i < item.childCount; ++i) {
+                program.code[targets + i] = program.label();
+                compileTsvExpression(program, flatSchema.child(item, i));
+                if (i + 1 < item.childCount) {
+                    jumps.push_back(program.emit({ParseProgram::JUMP, 0}));
                 }
             }
-            parse_items.emplace(it, SkipArray(elementsToSkip, schema->as<node::Array>().getItemsType(), *this));
-            return 1;
-    } else if (schema->is<node::Map>()) {
-            auto it = parse_items.begin();
-            parse_items.emplace(it, SkipMap(elementsToSkip, schema->as<node::Map>().getItemsType(), *this));
-            return 1;
-    } else {
-        if (schema->is<node::String>()) {
-            skipOrApplyCompileFilter<SkipString, ApplyString>(parse_items, schema, elementsToSkip);
-        } else if (schema->isOneOf<node::Enum, node::Int, node::Long>()) {
-            skipOrApplyCompileFilter<SkipInt, Apply<int>>(parse_items, schema, elementsToSkip);
-        } else if (schema->is<node::Float>()) {
-            skipOrApplyCompileFilter<SkipNBytes<4>, Apply<float>>(parse_items, schema, elementsToSkip);
-        } else if (schema->is<node::Double>()) {
-            skipOrApplyCompileFilter<SkipNBytes<8>, Apply<double>>(parse_items, schema, elementsToSkip);
-        } else if (schema->is<node::Boolean>()) {
-            skipOrApplyCompileFilter<SkipNBytes<1>, Apply<bool>>(parse_items, schema, elementsToSkip);
-        } else if (schema->is<node::Null>()) {
-            auto it = parse_items.begin();
-            parse_items.emplace(it, SkipNBytes<0>(elementsToSkip));
-            return 1; // Empty item. TODO: do not even insert it
-        } else {
-            // TODO fire runtime_error here
-            std::cout << schema->getItemName() << ":" << schema->getTypeName() << std::endl;
-            std::cout << "compileParser: Can't read type: no decoder. Finishing." << std::endl;
-            throw Eof();
-        }
-
-        return 1;
-    }
-}
-
-template <typename SkipType, typename ApplyType, typename... Args>
-void BlockDecoder::skipOrApplyCompileFilter(std::vector<parse_func_t> &parse_items, const std::unique_ptr<node::Node> &schema, int ret, Args... args) {
-    auto it = parse_items.begin();
-    if (predicates) {
-        auto range =  predicates->getEqualRange(schema.get());
-        if (range.first != range.second) {
-            parse_items.emplace(it, ApplyType(ret, range.first, range.second, args...));
-            return;
+            for(auto jump : jumps) {
+                program.code[jump + 1] = program.label();
+            }
+            break;
         }
-    }
-    parse_items.emplace(it, SkipType(ret, args...));
-}
-
-
-template<typename T>
-class ApplyTsv {
-public:
-    ApplyTsv(int ret,
-             dumper::TsvExpression::map_t::iterator start,
-             dumper::TsvExpression::map_t::iterator end)
-        : ret(ret),
-          start(start),
-          end(end) {
-    }
-    int operator() (DeflatedBuffer &stream, dumper::Tsv &tsv) {
-        const auto &value = TypeParser<T>::read(stream);
-        for_each (
-            start, end,
-            [&value, &tsv, this](const auto& tsvItem){
-                tsv.addToPosition(value, tsvItem.second);
+        case Type::CUSTOM:
+            compileTsvExpression(program, flatSchema.child(item, 0));
+            break;
+        case Type::ARRAY:
+        case Type::MAP:
+            if (printed) {
+                json();
+            } else {
+                compileSkip(program, index);
             }
-        );
-        return ret;
-    }
-private:
-    int ret;
-    dumper::TsvExpression::map_t::iterator start;
-    dumper::TsvExpression::map_t::iterator end;
-};
-
-
-class ApplyTsvNull {
-public:
-    ApplyTsvNull(int ret,
-                 dumper::TsvExpression::map_t::iterator start,
-                 dumper::TsvExpression::map_t::iterator end)
-        : ret(ret),
-          start(start),
-          end(end) {
-    }
-    int operator() (DeflatedBuffer &stream, dumper::Tsv &tsv) {
-        for_each (
-            start, end,
-            [&tsv, this](const auto& tsvItem){
-                tsv.addToPosition(stringifyedNull, tsvItem.second);
+            break;
+        case Type::STRING:
+            scalar(ParseProgram::TSV_STRING);
+            break;
+        case Type::INT:
+        case Type::LONG:
+            scalar(ParseProgram::TSV_INT);
+            break;
+        case Type::ENUM:
+            if (printed) {
+                program.emit({ParseProgram::TSV_ENUM, program.addFields(range), index});
+            } else {
+                compileSkip(program, index);
             }
-        );
-        return ret;
-    }
-private:
-    int ret;
-    const std::string stringifyedNull = "null";
-    dumper::TsvExpression::map_t::iterator start;
-    dumper::TsvExpression::map_t::iterator end;
-};
-
-class ApplyTsvEnum {
-public:
-    ApplyTsvEnum(int ret,
-                 dumper::TsvExpression::map_t::iterator start,
-                 dumper::TsvExpression::map_t::iterator end,
-                 const std::vector<std::string> &items)
-        : ret(ret),
-          start(start),
-          end(end),
-          items(items) {
-    }
-    int operator() (DeflatedBuffer &stream, dumper::Tsv &tsv) {
-        int item = TypeParser<int>::read(stream);
-
-        for_each (
-            start, end,
-            [&item, &tsv, this](const auto& tsvItem){
-                tsv.addToPosition(items[item], tsvItem.second);
+            break;
+        case Type::FLOAT:
+            scalar(ParseProgram::TSV_FLOAT);
+            break;
+        case Type::DOUBLE:
+            scalar(ParseProgram::TSV_DOUBLE);
+            break;
+        case Type::BOOLEAN:
+            scalar(ParseProgram::TSV_BOOLEAN);
+            break;
+        case Type::NULL_:
+            if (printed) {
+                program.emit({ParseProgram::TSV_NULL, program.addFields(range)});
             }
-        );
-
-        return ret;
+            break;
     }
-private:
-    const std::string stringifyedNull = "null";
-    int ret;
-    dumper::TsvExpression::map_t::iterator start;
-    dumper::TsvExpression::map_t::iterator end;
-    const std::vector<std::string> items;
-};
-
-class SkipTsvEnum {
-public:
-    SkipTsvEnum(int ret, const std::vector<std::string> &items)
-        : ret(ret) {
-          (void)items;
-    }
-    int operator() (DeflatedBuffer &stream, dumper::Tsv &tsv) {
-        TypeParser<int>::skip(stream);
-        return ret;
-    }
-private:
-    int ret;
-};
-
-class ApplyTsvAsJson {
-public:
-    ApplyTsvAsJson(int ret,
-        dumper::TsvExpression::map_t::iterator start,
-        dumper::TsvExpression::map_t::iterator end,
-        BlockDecoder::const_node_t &schema,
-        BlockDecoder &decoder)
-        : ret(ret),
-          nodeType(schema),
-          decoder(decoder),
-          start(start),
-          end(end) {
-    }
-    int operator() (DeflatedBuffer &stream, dumper::Tsv &tsv) {
-        dumper::Json<dumper::JsonTag::plain> dumper;
-
-        decoder.dumpDocument(stream, nodeType, dumper);
+}
 
-        const auto &value = dumper.GetAsString();
+namespace {
 
+    template <typename T>
+    void applyPredicates(const ParseProgram::predicates_t &range, const T &value) {
         for_each (
-            start, end,
-            [&value, &tsv, this](const auto& tsvItem){
-                tsv.addToPosition(value, tsvItem.second);
+            range.first, range.second,
+            [&value](const auto& filterItem){
+                filterItem.second->template apply<T>(value);
             }
         );
-
-        return ret;
-
-    }
-
-private:
-    int ret;
-    BlockDecoder::const_node_t &nodeType;
-    BlockDecoder &decoder;
-    dumper::TsvExpression::map_t::iterator start;
-    dumper::TsvExpression::map_t::iterator end;
-};
-
-template <typename T>
-class ParseToTsvAdapter : public T {
-public:
-    template<typename... Args>
-    ParseToTsvAdapter(Args... args)
-        : T(args...) {
     }
 
-    int operator() (DeflatedBuffer &stream, dumper::Tsv &tsv) {
-        return this->T::operator ()(stream);
+    template <typename T>
+    void addToFields(const ParseProgram::fields_t &range, const T &value, dumper::Tsv &tsv) {
+        std::for_each (
+            range.first, range.second,
+            [&value, &tsv](int position){
+                tsv.addToPosition(value, position);
+            }
+        );
     }
 
-};
-
-class JumpToNTsv {
-public:
-    JumpToNTsv(std::vector<int> &skipping)
-        : skipping(skipping) {
-    }
+    const std::string stringifyedNull = "null";
+}
 
-    int operator() (DeflatedBuffer &stream, dumper::Tsv &tsv) {
-        (void)tsv;
-        int i = TypeParser<int>::read(stream);
-        return skipping[i];
+void BlockDecoder::runProgram(const ParseProgram &program, DeflatedBuffer &stream, dumper::Tsv *tsv) {
+    if (program.empty()) {
+        return;
     }
+    const uint32_t *code = program.code.data();
+    const uint32_t *pc = code;
 
-private:
-    std::vector<int> skipping;
-};
-/*
-#include <list>
-#include <tuple>
-
-std::list<std::tuple<int,std::string, std::vector<int>>> debugTsvExpression;
-void _deb(int i, const std::unique_ptr<node::Node> &schema) {
-    debugTsvExpression.push_front(
-        std::tuple<int,std::string, std::vector<int>>(
-            i, schema->getItemName() + ':' + schema->getTypeName(), std::vector<int>())
-    );
-}
+    auto branch = [&stream](uint32_t count) {
+        const int64_t branch = TypeParser<long>::read(stream);
+        if (branch < 0 || branch >= int64_t(count)) {
+            throw std::runtime_error("Invalid union index " + std::to_string(branch));
+        }
+        return uint32_t(branch);
+    };
+
+    while (true) {
+        switch (pc[0]) {
+            case ParseProgram::END:
+                return;
+
+            case ParseProgram::SKIP_VARINTS:
+                skipZigZagLongs(stream, pc[1]);
+                pc += 2;
+                break;
+            case ParseProgram::SKIP_STRING:
+                TypeParser<StringBuffer>::skip(stream);
+                pc += 1;
+                break;
+            case ParseProgram::SKIP_BYTES:
+                stream.skip(pc[1]);
+                pc += 2;
+                break;
+            case ParseProgram::SKIP_VALUE:
+                skipDocument(stream, pc[1]);
+                pc += 2;
+                break;
+            case ParseProgram::JUMP:
+                pc = code + pc[1];
+                break;
+            case ParseProgram::UNION:
+                pc = code + pc[2 + branch(pc[1])];
+                break;
+
+            case ParseProgram::UNION_APPLY: {
+                const uint32_t n = branch(pc[3]);
+                const bool isNull = n == pc[2];
+                const auto &range = program.predicates[pc[1]];
+                for_each (
+                    range.first, range.second,
+                    [isNull](const auto& filterItem){
+                        filterItem.second->setIsNull(isNull);
+                    }
+                );
+                pc = code + pc[4 + n];
+                break;
+            }
+            case ParseProgram::APPLY_INT:
+                applyPredicates(program.predicates[pc[1]], TypeParser<int>::read(stream));
+                pc += 2;
+                break;
+            case ParseProgram::APPLY_FLOAT:
+                applyPredicates(program.predicates[pc[1]], TypeParser<float>::read(stream));
+                pc += 2;
+                break;
+            case ParseProgram::APPLY_DOUBLE:
+                applyPredicates(program.predicates[pc[1]], TypeParser<double>::read(stream));
+                pc += 2;
+                break;
+            case ParseProgram::APPLY_BOOLEAN:
+                applyPredicates(program.predicates[pc[1]], TypeParser<bool>::read(stream));
+                pc += 2;
+                break;
+            case ParseProgram::APPLY_STRING:
+                applyPredicates(program.predicates[pc[1]], TypeParser<StringBuffer>::read(stream));
+                pc += 2;
+                break;
+            case ParseProgram::RECORD_END: {
+                const auto &range = program.predicates[pc[1]];
+                for_each (
+                    range.first, range.second,
+                    [](const auto& filterItem){
+                        filterItem.second->recordEnd();
+                    }
+                );
+                pc += 2;
+                break;
+            }
+            case ParseProgram::APPLY_ARRAY: {
+                const auto &range = program.predicates[pc[1]];
+                int64_t objectsInBlock = 0;
+                do {
+                    objectsInBlock = readItemsCount(stream);
+                    for(int64_t i = 0; i < objectsInBlock && !stream.eof(); ++i) {
+                        decodeDocument(stream, pc[2]);
+                        for_each (
+                            range.first, range.second,
+                            [](const auto& filterItem){
+                                filterItem.second->pushArrayState();
+                            }
+                        );
+                    }
+                } while(objectsInBlock != 0);
+                pc += 3;
+                break;
+            }
 
-void _deb(int i, const std::unique_ptr<node::Node> &schema, std::vector<int> &v) {
-    debugTsvExpression.push_front(
-        std::tuple<int,std::string, std::vector<int>>(
-            i, schema->getItemName() + ':' + schema->getTypeName(), v)
-    );
-}*/
-/*
-void _dump_deb() {
-    int num = 0;
-    for(auto &i : debugTsvExpression) {
-        std::cout << num++ << ' ' << std::get<0>(i) << ' ' << std::get<1>(i);
-
-        if (std::get<2>(i).size() > 0) {
-            std::cout << '[';
-            for (int x : std::get<2>(i)) {
-                std::cout << x << ',';
+            case ParseProgram::TSV_INT:
+                addToFields(program.fields[pc[1]], TypeParser<int>::read(stream), *tsv);
+                pc += 2;
+                break;
+            case ParseProgram::TSV_FLOAT:
+                addToFields(program.fields[pc[1]], TypeParser<float>::read(stream), *tsv);
+                pc += 2;
+                break;
+            case ParseProgram::TSV_DOUBLE:
+                addToFields(program.fields[pc[1]], TypeParser<double>::read(stream), *tsv);
+                pc += 2;
+                break;
+            case ParseProgram::TSV_BOOLEAN:
+                addToFields(program.fields[pc[1]], TypeParser<bool>::read(stream), *tsv);
+                pc += 2;
+                break;
+            case ParseProgram::TSV_STRING:
+                addToFields(program.fields[pc[1]], TypeParser<StringBuffer>::read(stream), *tsv);
+                pc += 2;
+                break;
+            case ParseProgram::TSV_NULL:
+                addToFields(program.fields[pc[1]], stringifyedNull, *tsv);
+                pc += 2;
+                break;
+            case ParseProgram::TSV_ENUM: {
+                const auto &e = static_cast<const node::Enum &>(*flatSchema[pc[2]].node);
+                addToFields(program.fields[pc[1]], e[TypeParser<int>::read(stream)], *tsv);
+                pc += 3;
+                break;
+            }
+            case ParseProgram::TSV_JSON: {
+                dumper::Json<dumper::JsonTag::plain> dumper;
+                dumpDocument(stream, pc[2], dumper);
+                addToFields(program.fields[pc[1]], dumper.GetAsString(), *tsv);
+                pc += 3;
+                break;
             }
-            std::cout << ']';
         }
-
-        std::cout << std::endl;
     }
 }
-*/
-int BlockDecoder::compileTsvExpression(std::vector<dump_tsv_func_t> &parse_items, const std::unique_ptr<node::Node> &schema, int elementsToSkip) {
 
-    if (schema->is<node::Union>()) {
 
-        const auto &u = schema->as<node::Union>();
-
-        auto &children = u.getChildren();
-
-        std::vector<int> skipping;
-        int elementsLeft = elementsToSkip;
-        for(auto c = children.rbegin(); c != children.rend(); ++c) {
-            // auto p = skipping.begin();
-            elementsLeft += compileTsvExpression(parse_items, *c, elementsLeft);
-            skipping.push_back(elementsLeft - elementsToSkip);
-        }
-        /*if (schema->getItemName() == "demand") {
-            std::cout << "======= " << elementsToSkip << ' ' << elementsLeft << std::endl;
-        }*/
-        //_deb(elementsToSkip, schema, skipping);
-        auto it = parse_items.begin();
-        parse_items.emplace(it, JumpToNTsv(skipping));
-
-        return elementsLeft;
-    } else if (schema->is<node::Custom>()) {
-        return compileTsvExpression(parse_items, schema->as<node::Custom>().getDefinition());
-    } else if (schema->is<node::Record>()) {
-        auto p = tsvFieldsList.what.equal_range(schema->getNumber());
-        if (p.first != p.second) {
-            auto it = parse_items.begin();
-            parse_items.emplace(it, ApplyTsvAsJson(elementsToSkip, p.first, p.second, schema, *this));
-            return 1;
-        } else {
-            auto &children = schema->as<node::Record>().getChildren();
-            size_t size = 0;
-            for(auto c = children.rbegin(); c != children.rend(); ++c) {
-                size += compileTsvExpression(parse_items, *c);
+template <class T>
+void BlockDecoder::dumpDocument(DeflatedBuffer &stream, uint32_t index, T &dumper) {
+    using Type = node::FlatSchema::Type;
+
+    const auto &item = flatSchema[index];
+    if (item.custom) {
+        dumper.CustomBegin(*item.custom);
+    }
+    switch (item.type) {
+        case Type::RECORD: {
+            auto &r = static_cast<const node::Record &>(*item.node);
+            dumper.RecordBegin(r);
+            for(uint32_t i = 0; i < item.childCount; ++i) {
+                dumpDocument(stream, flatSchema.child(item, i), dumper);
             }
-            return size;
+            dumper.RecordEnd(r);
+            break;
         }
-
-    } else if (schema->is<node::Array>()) {
-        //_deb(elementsToSkip, schema);
-        auto p = tsvFieldsList.what.equal_range(schema->getNumber());
-        auto it = parse_items.begin();
-        if (p.first != p.second) {
-            parse_items.emplace(it, ApplyTsvAsJson(elementsToSkip, p.first, p.second, schema, *this));
-        } else {
-            parse_items.emplace(it, SkipArray(elementsToSkip, schema->as<node::Array>().getItemsType(), *this));
-        }
-        return 1;
-    } else if (schema->is<node::Map>()) {
-        //_deb(elementsToSkip, schema);
-        auto p = tsvFieldsList.what.equal_range(schema->getNumber());
-        auto it = parse_items.begin();
-        if (p.first != p.second) {
-            parse_items.emplace(it, ApplyTsvAsJson(elementsToSkip, p.first, p.second, schema, *this));
-        } else {
-            parse_items.emplace(it, SkipMap(elementsToSkip, schema->as<node::Map>().getItemsType(), *this));
+        case Type::UNION:
+            dumpDocument(stream, flatSchema.child(item, unionBranch(stream, item)), dumper);
+            break;
+        case Type::CUSTOM:
+            dumpDocument(stream, flatSchema.child(item, 0), dumper);
+            break;
+        case Type::ENUM: {
+            int index = readZigZagLong(stream);
+            dumper.Enum(static_cast<const node::Enum &>(*item.node), index);
+            break;
         }
-        return 1;
-    } else {
-        if (schema->is<node::String>()) {
-            //_deb(elementsToSkip, schema);
-            skipOrApplyTsvExpression<ParseToTsvAdapter<SkipString>, ApplyTsv<StringBuffer>>(parse_items, schema, elementsToSkip);
-        } else if (schema->isOneOf<node::Int, node::Long>()) {
-            //_deb(elementsToSkip, schema);
-            skipOrApplyTsvExpression<ParseToTsvAdapter<SkipInt>, ApplyTsv<int>>(parse_items, schema, elementsToSkip);
-        } else if (schema->is<node::Enum>()) {
-            //_deb(elementsToSkip, schema);
-            skipOrApplyTsvExpression<SkipTsvEnum, ApplyTsvEnum>(
-                    parse_items,
-                    schema,
-                    elementsToSkip,
-                    schema->as<node::Enum>().getItems()
-                );
-        } else if (schema->is<node::Float>()) {
-            //_deb(elementsToSkip, schema);
-            skipOrApplyTsvExpression<SkipNBytes<4>, ApplyTsv<float>>(parse_items, schema, elementsToSkip);
-        } else if (schema->is<node::Double>()) {
-            //_deb(elementsToSkip, schema);
-            skipOrApplyTsvExpression<SkipNBytes<8>, ApplyTsv<double>>(parse_items, schema, elementsToSkip);
-        } else if (schema->is<node::Boolean>()) {
-            //_deb(elementsToSkip, schema);
-            skipOrApplyTsvExpression<SkipNBytes<1>, ApplyTsv<bool>>(parse_items, schema, elementsToSkip);
-        } else if (schema->is<node::Null>()) {
-            //_deb(elementsToSkip, schema);
-            skipOrApplyTsvExpression<SkipNBytes<0>, ApplyTsvNull>(parse_items, schema, elementsToSkip);
-            return 1; // Empty item. TODO: do not even insert it
-        } else {
-            std::cout << schema->getItemName() << ":" << schema->getTypeName() << std::endl;
-            std::cout << "compileParser: Can't read type: no decoder. Finishing." << std::endl;
-            throw Eof();
+        case Type::ARRAY: {
+            auto &a = static_cast<const node::Array &>(*item.node);
+            const uint32_t items = flatSchema.child(item, 0);
+
+            dumper.ArrayBegin(a);
+            int64_t objectsInBlock = 0;
+            do {
+                objectsInBlock = readItemsCount(stream);
+                for(int64_t i = 0; i < objectsInBlock && !stream.eof(); ++i) {
+                    dumpDocument(stream, items, dumper);
+                }
+            } while(objectsInBlock != 0);
+            dumper.ArrayEnd(a);
+            break;
         }
-
-        return 1;
-    }
-}
-
-
-template <typename SkipType, typename ApplyType, typename... Args>
-void BlockDecoder::skipOrApplyTsvExpression(std::vector<dump_tsv_func_t> &parse_items, const std::unique_ptr<node::Node> &schema, int ret, Args... args) {
-    auto it = parse_items.begin();
-    auto p = tsvFieldsList.what.equal_range(schema->getNumber());
-    if (p.first != p.second) {
-        parse_items.emplace(it, ApplyType(ret, p.first, p.second, args...));
-        return;
-    }
-    parse_items.emplace(it, SkipType(ret, args...));
-}
-
-
-template <class T>
-void BlockDecoder::dumpDocument(DeflatedBuffer &stream, const std::unique_ptr<node::Node> &schema, T &dumper) {
-    if (schema->is<node::Record>()) {
-
-        auto &r = schema->as<node::Record>();
-        dumper.RecordBegin(r);
-        for(auto &p : schema->as<node::Record>().getChildren()) {
-            dumpDocument(stream, p, dumper);
+        case Type::MAP: {
+            auto &m = static_cast<const node::Map &>(*item.node);
+            const auto &values = flatSchema[flatSchema.child(item, 0)];
+
+            // TODO: refactor this trash
+            assert(values.type == Type::STRING || values.type == Type::INT);
+            dumper.MapBegin(m);
+            int64_t objectsInBlock = 0;
+            do {
+                objectsInBlock = readItemsCount(stream);
+
+                for(int64_t i = 0; i < objectsInBlock && !stream.eof(); ++i) {
+                    const auto & name  = stream.getString(readZigZagLong(stream));
+                    dumper.MapName(name);
+
+                    // TODO: refactor this trash
+                    if (values.type == Type::STRING) {
+                        const auto & value = stream.getString(readZigZagLong(stream));
+                        dumper.MapValue(value, static_cast<const node::String &>(*values.node));
+                    } else if (values.type == Type::INT) {
+                        const auto & value = readZigZagLong(stream);
+                        dumper.MapValue(value, static_cast<const node::Int &>(*values.node));
+                    }
+                }
+            } while(objectsInBlock != 0);
+            dumper.MapEnd(m);
+            break;
         }
-        dumper.RecordEnd(r);
-
-    } else if (schema->is<node::Union>()) {
-        int item = readZigZagLong(stream);
-        const auto &node = schema->as<node::Union>().getChildren()[item];
-        dumpDocument(stream, node, dumper);
-    } else if (schema->is<node::Custom>()) {
-        dumper.CustomBegin(schema->as<node::Custom>());
-        dumpDocument(stream, schema->as<node::Custom>().getDefinition(), dumper);
-    } else if (schema->is<node::Enum>()) {
-        int index = readZigZagLong(stream);
-        dumper.Enum(schema->as<node::Enum>(), index);
-
-    } else if (schema->is<node::Array>()) {
-        auto &a = schema->as<node::Array>();
-        auto const &node = a.getItemsType();
-
-        dumper.ArrayBegin(a);
-        int objectsInBlock = 0;
-        do {
-            objectsInBlock = readZigZagLong(stream);
-            for(int i = 0; i < objectsInBlock; ++i) {
-                dumpDocument(stream, node, dumper);
-            }
-        } while(objectsInBlock != 0);
-        dumper.ArrayEnd(a);
-
-    } else if (schema->is<node::Map>()) {
-        auto &m = schema->as<node::Map>();
-        auto const &node = m.getItemsType();
-
-        // TODO: refactor this trash
-        assert(node->is<node::String>() || node->is<node::Int>());
-        dumper.MapBegin(m);
-        int objectsInBlock = 0;
-        do {
-            objectsInBlock = readZigZagLong(stream);
-
-            for(int i = 0; i < objectsInBlock; ++i) {
-                const auto & name  = stream.getString(readZigZagLong(stream));
-                dumper.MapName(name);
-
-                // TODO: refactor this trash
-                if (node->is<node::String>()) {
-                    const auto & value = stream.getString(readZigZagLong(stream));
-                    dumper.MapValue(value, node->as<node::String>());
-                } else if (node->is<node::Int>()) {
-                     const auto & value = readZigZagLong(stream);
-                    dumper.MapValue(value, node->as<node::Int>());
-               }
-            }
-        } while(objectsInBlock != 0);
-        dumper.MapEnd(m);
-    } else {
-        if (schema->is<node::String>()) {
-            dumper.String(stream.getString(readZigZagLong(stream)), schema->as<node::String>());
-        } else if (schema->is<node::Int>()) {
+        case Type::STRING:
+            dumper.String(stream.getString(readZigZagLong(stream)), static_cast<const node::String &>(*item.node));
+            break;
+        case Type::INT: {
             int value = readZigZagLong(stream);
-            dumper.Int(value, schema->as<node::Int>());
-        } else if (schema->is<node::Long>()) {
+            dumper.Int(value, static_cast<const node::Int &>(*item.node));
+            break;
+        }
+        case Type::LONG: {
             long value = readZigZagLong(stream);
-            dumper.Long(value, schema->as<node::Long>());
-        } else if (schema->is<node::Float>()) {
+            dumper.Long(value, static_cast<const node::Long &>(*item.node));
+            break;
+        }
+        case Type::FLOAT: {
             float value = TypeParser<float>::read(stream);
-            dumper.Float(value, schema->as<node::Float>());
-        } else if (schema->is<node::Double>()) {
+            dumper.Float(value, static_cast<const node::Float &>(*item.node));
+            break;
+        }
+        case Type::DOUBLE: {
             double value =  TypeParser<double>::read(stream);
-            dumper.Double(value, schema->as<node::Double>());
-        } else if (schema->is<node::Boolean>()) {
+            dumper.Double(value, static_cast<const node::Double &>(*item.node));
+            break;
+        }
+        case Type::BOOLEAN: {
             bool value = TypeParser<bool>::read(stream);
-            dumper.Boolean(value, schema->as<node::Boolean>());
-        } else if (schema->is<node::Null>()) {
-            dumper.Null(schema->as<node::Null>());
-        } else {
-            std::cout << schema->getItemName() << ":" << schema->getTypeName() << std::endl;
-            std::cout << "Can't read type: no decoder. Finishing." << std::endl;
-            throw Eof();
+            dumper.Boolean(value, static_cast<const node::Boolean &>(*item.node));
+            break;
         }
+        case Type::NULL_:
+            dumper.Null(static_cast<const node::Null &>(*item.node));
+            break;
     }
 }
 
 
 template <typename T>
-void BlockDecoder::skipOrApplyFilter(DeflatedBuffer &stream, const std::unique_ptr<node::Node> &schema) {
-    if (predicates) {
-        auto range = predicates->getEqualRange(schema.get());
-        if (range.first != range.second) {
-            const auto &value = TypeParser<T>::read(stream);
-            for_each (
-                range.first,
-                range.second,
-                [&value](const auto& filterItem) {
-                    filterItem.second->template apply<T>(value);
-                }
-            );
-            return;
-        }
+void BlockDecoder::skipOrApplyFilter(DeflatedBuffer &stream, uint32_t index) {
+    const auto &range = itemPredicates[index];
+    if (range.first != range.second) {
+        const auto &value = TypeParser<T>::read(stream);
+        for_each (
+            range.first,
+            range.second,
+            [&value](const auto& filterItem) {
+                filterItem.second->template apply<T>(value);
+            }
+        );
+        return;
     }
     TypeParser<T>::skip(stream);
 }
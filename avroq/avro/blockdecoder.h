@@ -5,6 +5,8 @@
 #include <unordered_map>
 
 #include "dumper/tsvexpression.h"
+#include "node/flatschema.h"
+#include "parseprogram.h"
 #include "predicate/list.h"
 
 
@@ -29,65 +31,93 @@ namespace predicate {
     class Predicate;
     class List;
 }
+namespace sidecar {
+    struct BlockStats;
+    struct BlockBloom;
+}
 
 class BlockDecoder {
-    friend class SkipArray;
-    friend class ApplyArray;
-    friend class ApplyTsvAsJson;
-    friend class SkipMap;
-    using parse_func_t = std::function<int(DeflatedBuffer &)>;
-    using dump_tsv_func_t = std::function<int(DeflatedBuffer &, dumper::Tsv &t)>;
 public:
-    using const_node_t = const std::unique_ptr<node::Node>;
-
     BlockDecoder(const struct header &header, Limiter &limit);
 
     void decodeAndDumpBlock(Block &block);
+    // ranges of fields of TSV expression
+    void collectStats(Block &block, sidecar::BlockStats &stats);
+    // Bloom filters of fields of TSV expression
+    void collectBloom(Block &block, sidecar::BlockBloom &bloom);
+    // Offsets of every `every'-th record and of the end of the block, found
+    // by skipping records. Filter isn't applied, use a decoder without it
+    std::vector<size_t> findRecords(Block &block, size_t every);
     void setFilter(std::unique_ptr<filter::Filter> flt);
     void setTsvFilterExpression(const dumper::TsvExpression &tsvFieldsList);
     void setDumpMethod(std::function<void(const std::string &)> dumpMethod);
     void setCountMethod(std::function<void(size_t)> coutMethod);
     void enableCountOnlyMode();
     void enableParseLoop();
+    void enablePrintPosition();
     void outputAsJson(bool pretty);
 
 private:
     const struct header &header;
     Limiter &limit;
+    node::FlatSchema flatSchema;
     dumper::TsvExpression tsvFieldsList;
     std::unique_ptr<predicate::List> predicates;
+    // predicates of every item of flatSchema
+    std::vector<ParseProgram::predicates_t> itemPredicates;
+    // a block without any of them has no matching records
+    std::vector<std::string> requiredLiterals;
 
     std::function<void(const std::string &)> dumpMethod;
     std::function<void(size_t)> coutMethod;
     bool countOnly = false;
     bool parseLoopEnabled = false;
-    std::vector<parse_func_t> parseLoop;
-    std::vector<dump_tsv_func_t> tsvDumpLoop;
+    ParseProgram parseLoop;
+    // skips a record, for findRecords
+    ParseProgram skipLoop;
+    ParseProgram tsvDumpLoop;
     bool jsonMode = false;
     bool jsonPrettyMode = false;
+    bool printPosition = false;
+
+    // applies the filter to the value of schema item `index'
+    void decodeDocument(DeflatedBuffer &stream, uint32_t index);
+    // value without predicates inside
+    void skipDocument(DeflatedBuffer &stream, uint32_t index);
+    uint32_t unionBranch(DeflatedBuffer &stream, const node::FlatSchema::Item &item);
 
-    void decodeDocument(DeflatedBuffer &stream, const std::unique_ptr<node::Node> &schema);
+    // reads the record and applies the filter to it, a record cut by the end
+    // of a streamed window is read again once the window is grown
+    void filterDocument(DeflatedBuffer &stream, bool useParseLoop);
 
-    void dumpDocument(Block &block);
+    void dumpDocument(Block &block, int64_t record);
+
+    // every document of the block to the dumper, no filtering
+    template <class T>
+    void dumpBlock(Block &block, T &dumper);
 
     template <class T>
-    void dumpDocument(DeflatedBuffer &stream, const std::unique_ptr<node::Node> &schema, T &dumper);
+    void dumpDocument(DeflatedBuffer &stream, uint32_t index, T &dumper);
 
     template <typename T>
-    void skipOrApplyFilter(DeflatedBuffer &stream, const std::unique_ptr<node::Node> &schema);
+    void skipOrApplyFilter(DeflatedBuffer &stream, uint32_t index);
 
     template <typename T>
     typename T::result_type convertFilterConstant(const filter::equality_expression* expr, const node::Node *filterNode) const;
 
-    int compileFilteringParser(std::vector<parse_func_t> &parse_items, const std::unique_ptr<node::Node> &schema, int elementsToSkip = 1);
+    // reads a record applying predicates of the filter
+    ParseProgram compileFilter();
+    void compileFilter(ParseProgram &program, uint32_t index);
 
-    template <typename SkipType, typename ApplyType, typename... Args>
-    void skipOrApplyCompileFilter(std::vector<parse_func_t> &parse_items, const std::unique_ptr<node::Node> &schema, int ret, Args... args);
+    // skips the value, merging it with the skip before
+    void compileSkip(ParseProgram &program, uint32_t index);
 
-    int compileTsvExpression(std::vector<dump_tsv_func_t> &parse_items, const std::unique_ptr<node::Node> &schema, int elementsToSkip = 1);
+    // reads a record into fields of the TSV expression
+    ParseProgram compileTsvExpression();
+    void compileTsvExpression(ParseProgram &program, uint32_t index);
 
-    template <typename SkipType, typename ApplyType, typename... Args>
-    void skipOrApplyTsvExpression(std::vector<dump_tsv_func_t> &parse_items, const std::unique_ptr<node::Node> &schema, int ret, Args... args);
+    // `tsv' is needed by programs of TSV expressions only
+    void runProgram(const ParseProgram &program, DeflatedBuffer &stream, dumper::Tsv *tsv = nullptr);
 };
 
 
@@ -0,0 +1,71 @@
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include "bzip2.h"
+
+namespace avro {
+namespace codec {
+
+namespace {
+    const size_t MIN_GROWTH = 4 * 1024 * 1024;
+
+    void grow(storage_t &storage) {
+        storage.resize(storage.size() + std::max(storage.size(), MIN_GROWTH));
+    }
+}
+
+Bzip2::Bzip2() {
+    strm.bzalloc = nullptr;
+    strm.bzfree = nullptr;
+    strm.opaque = nullptr;
+}
+
+Bzip2::~Bzip2() {
+    if (initialized) {
+        BZ2_bzDecompressEnd(&strm);
+    }
+}
+
+StringBuffer Bzip2::decode(
+            const StringBuffer &encodedData,
+            storage_t &storage) {
+
+    // libbz2 can't reset a stream: state is freed and allocated again
+    if (initialized) {
+        BZ2_bzDecompressEnd(&strm);
+        initialized = false;
+    }
+    if (BZ2_bzDecompressInit(&strm, 0, 0) != BZ_OK) {
+        throw std::runtime_error("Can't initialize bzip2 decompression");
+    }
+    initialized = true;
+
+    strm.next_in = const_cast<char *>(encodedData.data());
+    strm.avail_in = encodedData.size();
+
+    size_t total = 0;
+    int ret;
+    do {
+        if (total == storage.size()) {
+            grow(storage);
+        }
+        strm.next_out = reinterpret_cast<char *>(storage.data() + total);
+        strm.avail_out = storage.size() - total;
+
+        ret = BZ2_bzDecompress(&strm);
+        total = storage.size() - strm.avail_out;
+
+        if (ret != BZ_OK && ret != BZ_STREAM_END) {
+            throw std::runtime_error("Bzip2 error: " + std::to_string(ret));
+        }
+        if (ret == BZ_OK && strm.avail_in == 0 && strm.avail_out > 0) {
+            throw std::runtime_error("Bzip2 block is truncated");
+        }
+    } while (ret != BZ_STREAM_END);
+
+    return StringBuffer(reinterpret_cast<const char *>(storage.data()), total);
+}
+
+}
+}
@@ -0,0 +1,31 @@
+#ifndef __avro_codec_bzip2_h_
+#define __avro_codec_bzip2_h_
+
+#include <bzlib.h>
+
+#include "codec.h"
+
+
+namespace avro {
+namespace codec {
+
+class Bzip2 : public Codec {
+public:
+
+    Bzip2();
+    Bzip2(const Bzip2 &) = delete;
+    virtual ~Bzip2();
+
+    virtual StringBuffer decode(
+                const StringBuffer &encodedData,
+                storage_t &storage);
+
+private:
+    bz_stream strm;
+    bool initialized = false;
+};
+
+}
+}
+
+#endif
@@ -8,5 +8,16 @@ namespace codec {
 Codec::~Codec() {
 }
 
+bool Codec::startStream(const StringBuffer &encodedData) {
+    (void)encodedData;
+    return false;
+}
+
+size_t Codec::decodeSome(uint8_t *to, size_t len) {
+    (void)to;
+    (void)len;
+    return 0;
+}
+
 }
 }
\ No newline at end of file
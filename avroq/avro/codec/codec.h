@@ -6,9 +6,14 @@
 
 #include <avro/stringbuffer.h>
 
+#include <util/defaultinitallocator.h>
+
 namespace avro {
 namespace codec {
 
+// Decoded blocks are written here, growing doesn't zero the buffer
+using storage_t = std::vector<uint8_t, util::default_init_allocator<uint8_t>>;
+
 class Codec {
 public:
 
@@ -16,7 +21,14 @@ public:
 
     virtual StringBuffer decode(
                 const StringBuffer &encodedData,
-                std::vector<uint8_t> &storage) = 0;
+                storage_t &storage) = 0;
+
+    // Decompression by parts while the block is read. False if the codec
+    // can't do it, decode() is used then
+    virtual bool startStream(const StringBuffer &encodedData);
+
+    // next bytes of the block given to startStream(), 0 at its end
+    virtual size_t decodeSome(uint8_t *to, size_t len);
 
 };
 
@@ -0,0 +1,156 @@
+#include <zlib.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define AVRO_CRC32_CLMUL
+#endif
+
+#include "crc32.h"
+
+namespace avro {
+namespace codec {
+
+namespace {
+
+    // zlib computes short and odd tails
+    uint32_t crc32Zlib(uint32_t crc, const unsigned char *data, size_t len) {
+        while (len > 0) {
+            const uInt chunk = len > (1u << 30) ? (1u << 30) : uInt(len);
+            crc = ::crc32(crc, data, chunk);
+            data += chunk;
+            len -= chunk;
+        }
+        return crc;
+    }
+
+#ifdef AVRO_CRC32_CLMUL
+
+    // Bit-reflected folding constants and Barrett reduction polynomial for
+    // CRC-32 from "Fast CRC Computation for Generic Polynomials Using
+    // PCLMULQDQ Instruction" by Intel
+    alignas(16) const uint64_t k1k2[] = { 0x0154442bd4, 0x01c6e41596 };
+    alignas(16) const uint64_t k3k4[] = { 0x01751997d0, 0x00ccaa009e };
+    alignas(16) const uint64_t k5k0[] = { 0x0163cd6124, 0x0000000000 };
+    alignas(16) const uint64_t poly[] = { 0x01db710641, 0x01f7011641 };
+
+    // `len' is at least 64 and a multiple of 16, `crc' is not inverted
+    __attribute__((target("pclmul,sse4.1")))
+    uint32_t crc32Clmul(uint32_t crc, const unsigned char *buf, size_t len) {
+        __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+
+        x1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf + 0x00));
+        x2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf + 0x10));
+        x3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf + 0x20));
+        x4 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf + 0x30));
+
+        x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(~crc));
+
+        x0 = _mm_load_si128(reinterpret_cast<const __m128i *>(k1k2));
+
+        buf += 64;
+        len -= 64;
+
+        // four independent folds of 64 bytes
+        while (len >= 64) {
+            x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+            x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+            x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+            x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+
+            x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+            x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+            x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+            x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+
+            y5 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf + 0x00));
+            y6 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf + 0x10));
+            y7 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf + 0x20));
+            y8 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf + 0x30));
+
+            x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), y5);
+            x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), y6);
+            x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), y7);
+            x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), y8);
+
+            buf += 64;
+            len -= 64;
+        }
+
+        // fold into 128 bits
+        x0 = _mm_load_si128(reinterpret_cast<const __m128i *>(k3k4));
+
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+        while (len >= 16) {
+            x2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf));
+
+            x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+            x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+            x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+            buf += 16;
+            len -= 16;
+        }
+
+        // fold 128 bits to 64
+        x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+        x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+        x1 = _mm_srli_si128(x1, 8);
+        x1 = _mm_xor_si128(x1, x2);
+
+        x0 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(k5k0));
+
+        x2 = _mm_srli_si128(x1, 4);
+        x1 = _mm_and_si128(x1, x3);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_xor_si128(x1, x2);
+
+        // Barrett reduction to 32 bits
+        x0 = _mm_load_si128(reinterpret_cast<const __m128i *>(poly));
+
+        x2 = _mm_and_si128(x1, x3);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+        x2 = _mm_and_si128(x2, x3);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        x1 = _mm_xor_si128(x1, x2);
+
+        return ~uint32_t(_mm_extract_epi32(x1, 1));
+    }
+
+    bool clmulSupported() {
+        static const bool supported = __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+        return supported;
+    }
+
+#endif
+
+}
+
+uint32_t crc32(const void *data, size_t len) {
+    auto buf = static_cast<const unsigned char *>(data);
+    uint32_t crc = 0;
+
+#ifdef AVRO_CRC32_CLMUL
+    if (len >= 64 && clmulSupported()) {
+        const size_t folded = len & ~size_t(15);
+        crc = crc32Clmul(crc, buf, folded);
+        buf += folded;
+        len -= folded;
+    }
+#endif
+
+    return crc32Zlib(crc, buf, len);
+}
+
+}
+}
@@ -0,0 +1,17 @@
+#ifndef __avro_codec_crc32_h_
+#define __avro_codec_crc32_h_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace avro {
+namespace codec {
+
+// CRC-32 (IEEE, as zlib's crc32()) of the buffer. Uses carry-less
+// multiplication folding when the CPU supports PCLMULQDQ
+uint32_t crc32(const void *data, size_t len);
+
+}
+}
+
+#endif
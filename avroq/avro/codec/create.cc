@@ -2,20 +2,41 @@
 
 #include <avro/header.h>
 
+#include "bzip2.h"
+#include "create.h"
 #include "deflate.h"
+#include "fastdeflate.h"
 #include "null.h"
+#include "snappy.h"
+#include "xz.h"
+#include "zstandard.h"
 
 namespace avro {
 namespace codec {
 
 
-std::shared_ptr<Codec> createForHeader(const ::avro::header &header) {
-    auto &codecName = header.metadata.at("avro.codec");
+const std::string &codecName(const ::avro::header &header) {
+    return header.metadata.at("avro.codec");
+}
+
+std::shared_ptr<Codec> createForHeader(const ::avro::header &header, const Options &options) {
+    auto &codecName = codec::codecName(header);
 
     if (codecName == "deflate") {
+        if (options.inflateEngine == Options::InflateEngine::FAST) {
+            return std::make_shared<FastDeflate>();
+        }
         return std::make_shared<Deflate>();
     } else if (codecName == "null") {
         return std::make_shared<Null>();
+    } else if (codecName == "snappy") {
+        return std::make_shared<Snappy>();
+    } else if (codecName == "zstandard") {
+        return std::make_shared<Zstd>();
+    } else if (codecName == "bzip2") {
+        return std::make_shared<Bzip2>();
+    } else if (codecName == "xz") {
+        return std::make_shared<Xz>();
     }
     throw std::runtime_error("Unsupported codec: " + codecName);
 }
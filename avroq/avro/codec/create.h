@@ -1,6 +1,8 @@
 #include <memory>
+#include <string>
 
 #include "codec.h"
+#include "options.h"
 
 
 namespace avro {
@@ -10,7 +12,10 @@ struct header;
 namespace codec {
 
 
-std::shared_ptr<Codec> createForHeader(const ::avro::header &header);
+const std::string &codecName(const ::avro::header &header);
+
+// Codecs keep decoder state between blocks: one instance per thread
+std::shared_ptr<Codec> createForHeader(const ::avro::header &header, const Options &options = Options());
 
 
 }
@@ -1,10 +1,9 @@
-#include <zlib.h>
 #include <assert.h>
 
+#include <algorithm>
 #include <iostream>
 #include <stdexcept>
 
-#include <util/onscopeexit.h>
 #include "deflate.h"    
 
 namespace avro {
@@ -16,58 +15,109 @@ namespace {
     {
         return b * 1024 * 1024;
     }
-}
 
-Deflate::~Deflate() {
-}
-
-StringBuffer Deflate::decode(
-            const StringBuffer &encodedData,
-            std::vector<uint8_t> &storage) {
+    // doubling keeps copying of already inflated data linear
+    void grow(storage_t &storage) {
+        storage.resize(storage.size() + std::max<size_t>(storage.size(), 4_MiB));
+    }
 
-    int ret;
-    z_stream strm;
+    void throwInflateError(const z_stream &strm) {
+        throw std::runtime_error(
+                std::string("Inflate error (Z_MEM_ERROR/Z_DATA_ERROR/Z_NEED_DICT/Z_BUF_ERROR): ") +
+                (strm.msg ? strm.msg : "")
+            );
+    }
+}
 
+Deflate::Deflate() {
     strm.zalloc = Z_NULL;
     strm.zfree = Z_NULL;
     strm.opaque = Z_NULL;
     strm.next_in = Z_NULL;
-    strm.total_out = 0;
-    ret = inflateInit2(&strm, -15);
+    strm.avail_in = 0;
+
+    if (inflateInit2(&strm, -15) != Z_OK) {
+        throw std::runtime_error("Can't initialize inflate");
+    }
+}
+
+Deflate::~Deflate() {
+    inflateEnd(&strm);
+}
+
+StringBuffer Deflate::decode(
+            const StringBuffer &encodedData,
+            storage_t &storage) {
 
+    int ret = inflateReset(&strm);
     assert(ret == Z_OK);
 
-    util::on_scope_exit cleanup([&]{inflateEnd(&strm);}); // std::bind(inflateEnd, &strm));
+    if (storage.size() < largestBlock) {
+        storage.resize(largestBlock);
+    }
 
     /* decompress until deflate stream ends or end of file */
     strm.avail_in = encodedData.size();
     strm.next_in  = (unsigned char *)(encodedData.data());
 
+    size_t total = 0;
     do {
 
-        if (strm.total_out == storage.size()) {
-            storage.resize(storage.size() + 4_MiB);
+        if (total == storage.size()) {
+            grow(storage);
         }
 
-        strm.avail_out = (uInt)storage.size() - strm.total_out;
-        strm.next_out = storage.data() + strm.total_out;
+        const size_t room = std::min<size_t>(storage.size() - total, UINT32_MAX);
+        strm.avail_out = (uInt)room;
+        strm.next_out = storage.data() + total;
 
         ret = inflate(&strm, Z_NO_FLUSH);
         assert(ret != Z_STREAM_ERROR);  /* state not clobbered */
 
+        total += room - strm.avail_out;
+
         if (ret == Z_STREAM_END) {
             break;
         } else if (ret != Z_OK) {
-            throw std::runtime_error(
-                    std::string("Inflate error (Z_MEM_ERROR/Z_DATA_ERROR/Z_NEED_DICT): ") +
-                    (strm.msg ? strm.msg : "")
-                );
+            throwInflateError(strm);
         }
 
     } while (ret != Z_STREAM_END);
 
-    return StringBuffer((const char *)storage.data(), strm.total_out);
+    largestBlock = std::max(largestBlock, total);
+
+    return StringBuffer((const char *)storage.data(), total);
+
+}
+
+bool Deflate::startStream(const StringBuffer &encodedData) {
+    int ret = inflateReset(&strm);
+    assert(ret == Z_OK);
+    (void)ret;
+
+    strm.avail_in = encodedData.size();
+    strm.next_in  = (unsigned char *)(encodedData.data());
+    streamEnded = false;
+    return true;
+}
+
+size_t Deflate::decodeSome(uint8_t *to, size_t len) {
+    const size_t room = std::min<size_t>(len, UINT32_MAX);
+    strm.next_out = to;
+    strm.avail_out = (uInt)room;
+
+    // a call may only read input, 0 bytes mean the end of the block
+    while (!streamEnded && strm.avail_out == room) {
+        int ret = inflate(&strm, Z_NO_FLUSH);
+        assert(ret != Z_STREAM_ERROR);  /* state not clobbered */
 
+        if (ret == Z_STREAM_END) {
+            streamEnded = true;
+        } else if (ret != Z_OK) {
+            throwInflateError(strm);
+        }
+    }
+    return room - strm.avail_out;
 }
 
 
@@ -1,23 +1,38 @@
 #ifndef __avro_codec_deflate_h_
 #define __avro_codec_deflate_h_
 
+#include <zlib.h>
+
 #include "codec.h"
 
 
 namespace avro {
 namespace codec {
 
+// Inflate state is reset between blocks instead of being created for each
 class Deflate : public Codec {
 public:
 
+    Deflate();
+    Deflate(const Deflate &) = delete;
     virtual ~Deflate();
 
     virtual StringBuffer decode(
                 const StringBuffer &encodedData,
-                std::vector<uint8_t> &storage);
+                storage_t &storage);
+
+    virtual bool startStream(const StringBuffer &encodedData);
+    virtual size_t decodeSome(uint8_t *to, size_t len);
+
+private:
+    z_stream strm;
+    bool streamEnded = false;
+    // storage is made this big before inflating, so blocks of similar
+    // size are inflated without growing it
+    size_t largestBlock = 0;
 };
 
 }
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,72 @@
+#include <algorithm>
+
+#include "fastdeflate.h"
+
+namespace avro {
+namespace codec {
+
+
+namespace {
+    constexpr unsigned long long operator"" _MiB ( unsigned long long b )
+    {
+        return b * 1024 * 1024;
+    }
+
+    // deflate can't compress better than that, bigger output means broken data
+    const size_t MAX_RATIO = 1032;
+}
+
+FastDeflate::FastDeflate() : inflater(new Inflater()) {
+}
+
+StringBuffer FastDeflate::decode(
+            const StringBuffer &encodedData,
+            storage_t &storage) {
+
+    const size_t limit = encodedData.size() * MAX_RATIO + 1_MiB;
+
+    // output size is unknown: a block which doesn't fit is inflated again
+    // into the size it needs, largestBlock makes it rare
+    size_t room = std::max<size_t>(largestBlock, 4_MiB);
+    while (true) {
+        if (storage.size() < room + Inflater::OUTPUT_SLACK) {
+            storage.resize(room + Inflater::OUTPUT_SLACK);
+        }
+        room = storage.size() - Inflater::OUTPUT_SLACK;
+
+        size_t total = 0;
+        auto result = inflater->inflate(
+                (const uint8_t *)encodedData.data(), encodedData.size(),
+                storage.data(), room, total);
+
+        if (result == Inflater::OK) {
+            largestBlock = std::max(largestBlock, total);
+            return StringBuffer((const char *)storage.data(), total);
+        }
+        if (result == Inflater::BAD_DATA || total > limit || total <= room) {
+            break;
+        }
+        room = total;
+    }
+
+    return zlib().decode(encodedData, storage);
+}
+
+bool FastDeflate::startStream(const StringBuffer &encodedData) {
+    return zlib().startStream(encodedData);
+}
+
+size_t FastDeflate::decodeSome(uint8_t *to, size_t len) {
+    return zlib().decodeSome(to, len);
+}
+
+Deflate &FastDeflate::zlib() {
+    if (!fallback) {
+        fallback.reset(new Deflate());
+    }
+    return *fallback;
+}
+
+
+}
+}
@@ -0,0 +1,42 @@
+#ifndef __avro_codec_fastdeflate_h_
+#define __avro_codec_fastdeflate_h_
+
+#include <memory>
+
+#include "codec.h"
+#include "deflate.h"
+#include "inflater.h"
+
+
+namespace avro {
+namespace codec {
+
+// Blocks are inflated by Inflater in one go. Data it rejects is given to
+// zlib, so corrupted blocks are reported the same way as by Deflate
+class FastDeflate : public Codec {
+public:
+
+    FastDeflate();
+    FastDeflate(const FastDeflate &) = delete;
+
+    virtual StringBuffer decode(
+                const StringBuffer &encodedData,
+                storage_t &storage);
+
+    // streams are inflated by zlib
+    virtual bool startStream(const StringBuffer &encodedData);
+    virtual size_t decodeSome(uint8_t *to, size_t len);
+
+private:
+    // tables are big enough to keep them off the stack
+    std::unique_ptr<Inflater> inflater;
+    std::unique_ptr<Deflate> fallback;
+    size_t largestBlock = 0;
+
+    Deflate &zlib();
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,438 @@
+#include <cstring>
+
+#include "inflater.h"
+
+namespace avro {
+namespace codec {
+
+namespace {
+    // Table entry: bits 0-4 are bits to consume, 5-7 flags, 8-11 number of
+    // extra bits, 16-31 value: literal, base of length or distance, or
+    // start of a subtable. Zero entry is an invalid code
+    const uint32_t LITERAL = 1 << 5;
+    const uint32_t END_OF_BLOCK = 1 << 6;
+    const uint32_t SUBTABLE = 1 << 7;
+
+    // symbol which must not appear in data
+    const uint32_t INVALID_SYMBOL = ~uint32_t(0);
+
+    const unsigned MAX_CODE_LENGTH = 15;
+
+    inline uint32_t entry(uint32_t flags, uint32_t extra, uint32_t value) {
+        return flags | (extra << 8) | (value << 16);
+    }
+
+    inline unsigned consumeBits(uint32_t e) { return e & 31; }
+    inline unsigned extraBits(uint32_t e) { return (e >> 8) & 15; }
+    inline unsigned value(uint32_t e) { return e >> 16; }
+
+    const uint16_t LENGTH_BASE[] = {
+        3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+    };
+    const uint8_t LENGTH_EXTRA[] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+    };
+    const uint16_t DIST_BASE[] = {
+        1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+        257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+    };
+    const uint8_t DIST_EXTRA[] = {
+        0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+        7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+    };
+
+    const uint8_t PRECODE_ORDER[] = {
+        16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+    };
+
+    // entries of symbols without bits to consume
+    struct Symbols {
+        uint32_t litlen[288];
+        uint32_t dist[32];
+        uint32_t precode[19];
+
+        Symbols() {
+            for(unsigned s = 0; s < 256; ++s) {
+                litlen[s] = entry(LITERAL, 0, s);
+            }
+            litlen[256] = entry(END_OF_BLOCK, 0, 0);
+            for(unsigned s = 257; s < 286; ++s) {
+                litlen[s] = entry(0, LENGTH_EXTRA[s - 257], LENGTH_BASE[s - 257]);
+            }
+            litlen[286] = litlen[287] = INVALID_SYMBOL;
+
+            for(unsigned s = 0; s < 30; ++s) {
+                dist[s] = entry(0, DIST_EXTRA[s], DIST_BASE[s]);
+            }
+            dist[30] = dist[31] = INVALID_SYMBOL;
+
+            for(unsigned s = 0; s < 19; ++s) {
+                precode[s] = entry(0, 0, s);
+            }
+        }
+    };
+
+    const Symbols symbols;
+
+    inline uint64_t load64(const uint8_t *p) {
+        uint64_t v;
+        memcpy(&v, p, sizeof v);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        v = __builtin_bswap64(v);
+#endif
+        return v;
+    }
+
+    inline unsigned reverseBits(unsigned code, unsigned len) {
+        unsigned result = 0;
+        for(unsigned i = 0; i < len; ++i) {
+            result = (result << 1) | (code & 1);
+            code >>= 1;
+        }
+        return result;
+    }
+
+    // Bits of input, least significant first. Reading past the end of input
+    // gives zeros, `overread' counts such bytes
+    struct BitReader {
+        const uint8_t *in;
+        const uint8_t *end;
+        uint64_t bitbuf = 0;
+        unsigned bitsleft = 0;
+        size_t overread = 0;
+
+        BitReader(const uint8_t *in, size_t len) : in(in), end(in + len) {
+        }
+
+        // at least 56 bits are available after it, false if bits which
+        // were not in input were used already: the stream is cut
+        inline bool refill() {
+            if (end - in >= 8) {
+                // bytes above `bitsleft' are loaded again by the next refill
+                bitbuf |= load64(in) << bitsleft;
+                in += (63 - bitsleft) >> 3;
+                bitsleft |= 56;
+                return true;
+            }
+            while (bitsleft <= 56) {
+                if (in < end) {
+                    bitbuf |= uint64_t(*in++) << bitsleft;
+                } else {
+                    ++overread;
+                }
+                bitsleft += 8;
+            }
+            return valid();
+        }
+
+        inline unsigned peek(unsigned n) const {
+            return bitbuf & ((uint64_t(1) << n) - 1);
+        }
+
+        inline void consume(unsigned n) {
+            bitbuf >>= n;
+            bitsleft -= n;
+        }
+
+        inline unsigned get(unsigned n) {
+            unsigned v = peek(n);
+            consume(n);
+            return v;
+        }
+
+        // real bytes which are in the bit buffer are given back to input
+        bool alignToByte() {
+            consume(bitsleft & 7);
+            size_t bytes = bitsleft / 8;
+            if (overread > bytes) {
+                return false;
+            }
+            in -= bytes - overread;
+            bitbuf = 0;
+            bitsleft = 0;
+            overread = 0;
+            return true;
+        }
+
+        // false if bits which were not in input were used
+        bool valid() const {
+            return overread * 8 <= bitsleft;
+        }
+    };
+
+    inline uint32_t lookup(const uint32_t *table, unsigned tableBits, BitReader &bits) {
+        uint32_t e = table[bits.peek(tableBits)];
+        if (e & SUBTABLE) {
+            bits.consume(tableBits);
+            e = table[value(e) + bits.peek(extraBits(e))];
+        }
+        bits.consume(consumeBits(e));
+        return e;
+    }
+
+    inline void copyMatch(uint8_t *out, size_t distance, size_t length) {
+        const uint8_t *src = out - distance;
+        if (distance >= 8) {
+            uint8_t *const end = out + length;
+            do {
+                memcpy(out, src, 8);
+                out += 8;
+                src += 8;
+            } while (out < end);
+        } else if (distance == 1) {
+            memset(out, *src, length);
+        } else {
+            for(size_t i = 0; i < length; ++i) {
+                out[i] = src[i];
+            }
+        }
+    }
+}
+
+bool Inflater::buildTable(uint32_t *table, const uint8_t *lens, size_t n,
+                          const uint32_t *symbolEntries, unsigned tableBits) {
+    unsigned count[MAX_CODE_LENGTH + 1] = {0};
+    for(size_t s = 0; s < n; ++s) {
+        ++count[lens[s]];
+    }
+    count[0] = 0;
+
+    unsigned maxLen = 0;
+    int left = 1;
+    size_t codes = 0;
+    for(unsigned len = 1; len <= MAX_CODE_LENGTH; ++len) {
+        left <<= 1;
+        left -= count[len];
+        if (left < 0) {
+            return false; // over-subscribed
+        }
+        if (count[len]) {
+            maxLen = len;
+        }
+        codes += count[len];
+    }
+
+    memset(table, 0, sizeof(uint32_t) << tableBits);
+
+    // incomplete code is allowed for a single code of one bit only, missing
+    // codes are left invalid
+    if (left > 0 && !(codes == 0 || (codes == 1 && maxLen == 1))) {
+        return false;
+    }
+
+    unsigned nextCode[MAX_CODE_LENGTH + 2];
+    unsigned code = 0;
+    for(unsigned len = 1; len <= MAX_CODE_LENGTH; ++len) {
+        code = (code + count[len - 1]) << 1;
+        nextCode[len] = code;
+    }
+
+    const unsigned subBits = maxLen > tableBits ? maxLen - tableBits : 0;
+    size_t nextSubtable = size_t(1) << tableBits;
+    const unsigned mask = (1u << tableBits) - 1;
+
+    for(size_t s = 0; s < n; ++s) {
+        const unsigned len = lens[s];
+        if (len == 0) {
+            continue;
+        }
+        const unsigned rev = reverseBits(nextCode[len]++, len);
+        const uint32_t e = symbolEntries[s];
+
+        if (len <= tableBits) {
+            const uint32_t filled = e == INVALID_SYMBOL ? 0 : e | len;
+            for(unsigned i = rev; i <= mask; i += 1u << len) {
+                table[i] = filled;
+            }
+            continue;
+        }
+
+        uint32_t &head = table[rev & mask];
+        if (!(head & SUBTABLE)) {
+            head = entry(SUBTABLE, subBits, nextSubtable) | tableBits;
+            memset(table + nextSubtable, 0, sizeof(uint32_t) << subBits);
+            nextSubtable += size_t(1) << subBits;
+        }
+        const unsigned subLen = len - tableBits;
+        const uint32_t filled = e == INVALID_SYMBOL ? 0 : e | subLen;
+        for(unsigned i = rev >> tableBits; i < (1u << subBits); i += 1u << subLen) {
+            table[value(head) + i] = filled;
+        }
+    }
+    return true;
+}
+
+void Inflater::buildFixed() {
+    uint8_t lens[288 + 32];
+    memset(lens, 8, 144);
+    memset(lens + 144, 9, 112);
+    memset(lens + 256, 7, 24);
+    memset(lens + 280, 8, 8);
+    memset(lens + 288, 5, 32);
+
+    buildTable(fixedLitlen, lens, 288, symbols.litlen, LITLEN_BITS);
+    buildTable(fixedDist, lens + 288, 32, symbols.dist, DIST_BITS);
+    fixedBuilt = true;
+}
+
+Inflater::Result Inflater::inflate(const uint8_t *in, size_t inLen, uint8_t *out, size_t outLen, size_t &written) {
+    BitReader bits(in, inLen);
+    uint8_t *const outStart = out;
+    uint8_t *const outEnd = out + outLen;
+
+    // output which didn't fit is counted only, to tell the size needed
+    size_t overflow = 0;
+
+    bool last;
+    do {
+        if (!bits.refill()) {
+            return BAD_DATA;
+        }
+        last = bits.get(1);
+        const unsigned type = bits.get(2);
+
+        const uint32_t *litlenTable = litlen;
+        const uint32_t *distTable = dist;
+
+        if (type == 0) {
+            if (!bits.alignToByte() || bits.end - bits.in < 4) {
+                return BAD_DATA;
+            }
+            const unsigned len = bits.in[0] | (bits.in[1] << 8);
+            const unsigned nlen = bits.in[2] | (bits.in[3] << 8);
+            bits.in += 4;
+            if (len != (~nlen & 0xffff) || size_t(bits.end - bits.in) < len) {
+                return BAD_DATA;
+            }
+            if (size_t(outEnd - out) < len) {
+                overflow += len - (outEnd - out);
+                out = outEnd;
+            } else {
+                memcpy(out, bits.in, len);
+                out += len;
+            }
+            bits.in += len;
+            continue;
+        } else if (type == 1) {
+            if (!fixedBuilt) {
+                buildFixed();
+            }
+            litlenTable = fixedLitlen;
+            distTable = fixedDist;
+        } else if (type == 2) {
+            const unsigned hlit = bits.get(5) + 257;
+            const unsigned hdist = bits.get(5) + 1;
+            const unsigned hclen = bits.get(4) + 4;
+
+            uint8_t precodeLens[19] = {0};
+            for(unsigned i = 0; i < hclen; ++i) {
+                if (!bits.refill()) {
+                    return BAD_DATA;
+                }
+                precodeLens[PRECODE_ORDER[i]] = bits.get(3);
+            }
+            if (!buildTable(precode, precodeLens, 19, symbols.precode, PRECODE_BITS)) {
+                return BAD_DATA;
+            }
+
+            uint8_t lens[288 + 32];
+            for(unsigned i = 0; i < hlit + hdist; ) {
+                if (!bits.refill()) {
+                    return BAD_DATA;
+                }
+                const uint32_t e = precode[bits.peek(PRECODE_BITS)];
+                if (!e) {
+                    return BAD_DATA;
+                }
+                bits.consume(consumeBits(e));
+                const unsigned sym = value(e);
+
+                if (sym < 16) {
+                    lens[i++] = sym;
+                    continue;
+                }
+                unsigned repeat;
+                uint8_t len = 0;
+                if (sym == 16) {
+                    if (i == 0) {
+                        return BAD_DATA;
+                    }
+                    len = lens[i - 1];
+                    repeat = 3 + bits.get(2);
+                } else if (sym == 17) {
+                    repeat = 3 + bits.get(3);
+                } else {
+                    repeat = 11 + bits.get(7);
+                }
+                if (i + repeat > hlit + hdist) {
+                    return BAD_DATA;
+                }
+                memset(lens + i, len, repeat);
+                i += repeat;
+            }
+
+            if (lens[256] == 0 ||
+                    !buildTable(litlen, lens, hlit, symbols.litlen, LITLEN_BITS) ||
+                    !buildTable(dist, lens + hlit, hdist, symbols.dist, DIST_BITS)) {
+                return BAD_DATA;
+            }
+        } else {
+            return BAD_DATA;
+        }
+
+        while (true) {
+            // the longest length and distance with extra bits take 48 bits
+            if (bits.bitsleft < 48 && !bits.refill()) {
+                return BAD_DATA;
+            }
+
+            uint32_t e = lookup(litlenTable, LITLEN_BITS, bits);
+
+            if (e & LITERAL) {
+                if (out == outEnd) {
+                    ++overflow;
+                    continue;
+                }
+                *out++ = value(e);
+                continue;
+            }
+            if (e & END_OF_BLOCK) {
+                break;
+            }
+            if (!e) {
+                return BAD_DATA;
+            }
+
+            const size_t length = value(e) + bits.get(extraBits(e));
+
+            e = lookup(distTable, DIST_BITS, bits);
+            if (!e) {
+                return BAD_DATA;
+            }
+            const size_t distance = value(e) + bits.get(extraBits(e));
+
+            if (distance > size_t(out - outStart) + overflow) {
+                return BAD_DATA;
+            }
+            if (length > size_t(outEnd - out)) {
+                overflow += length - (outEnd - out);
+                out = outEnd;
+                continue;
+            }
+            copyMatch(out, distance, length);
+            out += length;
+        }
+    } while (!last);
+
+    if (!bits.valid()) {
+        return BAD_DATA;
+    }
+
+    written = out - outStart + overflow;
+    return overflow ? SHORT_OUTPUT : OK;
+}
+
+}
+}
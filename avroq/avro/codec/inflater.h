@@ -0,0 +1,54 @@
+#ifndef __avro_codec_inflater_h_
+#define __avro_codec_inflater_h_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace avro {
+namespace codec {
+
+/*
+ * Raw deflate (RFC 1951) decoder for streams which are in memory as
+ * a whole and are decompressed into a buffer at once. Unlike zlib's
+ * inflate() it keeps no state between calls, reads input by 64 bits
+ * and copies matches by 8 bytes, so output needs 8 bytes of room after
+ * `outLen'.
+ */
+class Inflater {
+public:
+    enum Result {
+        OK,
+        BAD_DATA,
+        SHORT_OUTPUT
+    };
+
+    // bytes after `out + outLen' could be overwritten, up to OUTPUT_SLACK
+    static const size_t OUTPUT_SLACK = 8;
+
+    // SHORT_OUTPUT if the stream is valid but doesn't fit into `outLen'
+    // bytes, `written' is the size it needs then
+    Result inflate(const uint8_t *in, size_t inLen, uint8_t *out, size_t outLen, size_t &written);
+
+private:
+    static const unsigned LITLEN_BITS = 11;
+    static const unsigned DIST_BITS = 8;
+    static const unsigned PRECODE_BITS = 7;
+
+    // main tables and their subtables for codes longer than the main table's bits
+    uint32_t litlen[(1 << LITLEN_BITS) + 288 * 16];
+    uint32_t dist[(1 << DIST_BITS) + 32 * 128];
+    uint32_t precode[1 << PRECODE_BITS];
+
+    bool fixedBuilt = false;
+    uint32_t fixedLitlen[(1 << LITLEN_BITS) + 288 * 16];
+    uint32_t fixedDist[(1 << DIST_BITS) + 32 * 128];
+
+    static bool buildTable(uint32_t *table, const uint8_t *lens, size_t n,
+                           const uint32_t *symbols, unsigned tableBits);
+    void buildFixed();
+};
+
+}
+}
+
+#endif
@@ -15,7 +15,7 @@ Null::~Null() {
 
 StringBuffer Null::decode(
             const StringBuffer &encodedData,
-            std::vector<uint8_t> &storage) {
+            storage_t &storage) {
 
     return encodedData;
 
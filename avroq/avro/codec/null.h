@@ -14,7 +14,7 @@ public:
 
     virtual StringBuffer decode(
                 const StringBuffer &encodedData,
-                std::vector<uint8_t> &storage);
+                storage_t &storage);
 };
 
 }
@@ -0,0 +1,27 @@
+#ifndef __avro_codec_options_h_
+#define __avro_codec_options_h_
+
+#include <cstddef>
+
+namespace avro {
+namespace codec {
+
+struct Options {
+    enum class InflateEngine {
+        // zlib's inflate(), see Deflate
+        ZLIB,
+        // whole block at once, see FastDeflate
+        FAST
+    };
+
+    InflateEngine inflateEngine = InflateEngine::ZLIB;
+
+    // Deflate blocks are inflated by parts while records are decoded, at
+    // least this many bytes ahead. 0 inflates a whole block first
+    size_t inflateWindow = 0;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,168 @@
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "crc32.h"
+#include "snappy.h"
+
+namespace avro {
+namespace codec {
+
+namespace {
+    const size_t CRC_LENGTH = 4;
+
+    // short literals and copies are written by 16 and 8 bytes, output
+    // has that much room after the end
+    const size_t SLACK = 16;
+
+    [[noreturn]] void corrupted(const std::string &why) {
+        throw std::runtime_error("Corrupted snappy block: " + why);
+    }
+
+    bool readVarint32(const uint8_t *&p, const uint8_t *end, uint32_t &value) {
+        uint32_t result = 0;
+        for(int shift = 0; shift < 35 && p < end; shift += 7) {
+            const uint8_t b = *p++;
+            result |= uint32_t(b & 0x7f) << shift;
+            if (!(b & 0x80)) {
+                value = result;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    uint32_t readLittleEndian(const uint8_t *p, size_t bytes) {
+        uint32_t result = 0;
+        for(size_t i = 0; i < bytes; ++i) {
+            result |= uint32_t(p[i]) << (8 * i);
+        }
+        return result;
+    }
+
+    // `offset' could be less than `len': the copy repeats the last bytes
+    inline void copyMatch(uint8_t *op, size_t offset, size_t len) {
+        const uint8_t *src = op - offset;
+        if (offset >= 8) {
+            uint8_t *const end = op + len;
+            while (op < end) {
+                memcpy(op, src, 8);
+                op += 8;
+                src += 8;
+            }
+        } else {
+            for(size_t i = 0; i < len; ++i) {
+                op[i] = src[i];
+            }
+        }
+    }
+}
+
+Snappy::~Snappy() {
+}
+
+StringBuffer Snappy::decode(
+            const StringBuffer &encodedData,
+            storage_t &storage) {
+
+    if (encodedData.size() < CRC_LENGTH) {
+        corrupted("no checksum");
+    }
+
+    const uint8_t *ip = reinterpret_cast<const uint8_t *>(encodedData.data());
+    // checksum bytes could be read but are not data
+    const uint8_t *const readable = ip + encodedData.size();
+    const uint8_t *const ipEnd = readable - CRC_LENGTH;
+
+    uint32_t length = 0;
+    if (!readVarint32(ip, ipEnd, length)) {
+        corrupted("bad length");
+    }
+
+    if (storage.size() < length + SLACK) {
+        storage.resize(length + SLACK);
+    }
+    uint8_t *const base = storage.data();
+    uint8_t *op = base;
+    uint8_t *const opEnd = base + length;
+
+    while (ip < ipEnd) {
+        const uint8_t tag = *ip++;
+        size_t len;
+        size_t offset;
+
+        switch (tag & 3) {
+            case 0: {
+                len = tag >> 2;
+                if (len >= 60) {
+                    const size_t bytes = len - 59;
+                    if (size_t(ipEnd - ip) < bytes) {
+                        corrupted("truncated literal length");
+                    }
+                    len = readLittleEndian(ip, bytes);
+                    ip += bytes;
+                }
+                ++len;
+                if (len > size_t(opEnd - op)) {
+                    corrupted("literal is out of block");
+                }
+                if (len > size_t(ipEnd - ip)) {
+                    corrupted("truncated literal");
+                }
+                if (len <= 16 && readable - ip >= 16) {
+                    memcpy(op, ip, 16);
+                } else {
+                    memcpy(op, ip, len);
+                }
+                op += len;
+                ip += len;
+                continue;
+            }
+            case 1:
+                if (ip >= ipEnd) {
+                    corrupted("truncated copy");
+                }
+                len = 4 + ((tag >> 2) & 7);
+                offset = (size_t(tag >> 5) << 8) | *ip++;
+                break;
+            case 2:
+                if (ipEnd - ip < 2) {
+                    corrupted("truncated copy");
+                }
+                len = 1 + (tag >> 2);
+                offset = readLittleEndian(ip, 2);
+                ip += 2;
+                break;
+            default:
+                if (ipEnd - ip < 4) {
+                    corrupted("truncated copy");
+                }
+                len = 1 + (tag >> 2);
+                offset = readLittleEndian(ip, 4);
+                ip += 4;
+                break;
+        }
+
+        if (offset == 0 || offset > size_t(op - base) || len > size_t(opEnd - op)) {
+            corrupted("bad copy");
+        }
+        copyMatch(op, offset, len);
+        op += len;
+    }
+
+    if (op != opEnd) {
+        corrupted("length mismatch");
+    }
+
+    const uint8_t *c = ipEnd;
+    const uint32_t expected = (uint32_t(c[0]) << 24) | (uint32_t(c[1]) << 16) | (uint32_t(c[2]) << 8) | c[3];
+    if (crc32(base, length) != expected) {
+        throw std::runtime_error("Snappy block checksum mismatch");
+    }
+
+    return StringBuffer(reinterpret_cast<const char *>(base), length);
+}
+
+
+}
+}
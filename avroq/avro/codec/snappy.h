@@ -0,0 +1,24 @@
+#ifndef __avro_codec_snappy_h_
+#define __avro_codec_snappy_h_
+
+#include "codec.h"
+
+
+namespace avro {
+namespace codec {
+
+// Raw snappy block followed by big-endian CRC-32 of uncompressed data
+class Snappy : public Codec {
+public:
+
+    virtual ~Snappy();
+
+    virtual StringBuffer decode(
+                const StringBuffer &encodedData,
+                storage_t &storage);
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,59 @@
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include "xz.h"
+
+namespace avro {
+namespace codec {
+
+namespace {
+    const size_t MIN_GROWTH = 4 * 1024 * 1024;
+
+    void grow(storage_t &storage) {
+        storage.resize(storage.size() + std::max(storage.size(), MIN_GROWTH));
+    }
+}
+
+Xz::Xz() {
+}
+
+Xz::~Xz() {
+    lzma_end(&strm);
+}
+
+StringBuffer Xz::decode(
+            const StringBuffer &encodedData,
+            storage_t &storage) {
+
+    // initializing the same stream again reuses decoder's memory
+    if (lzma_stream_decoder(&strm, UINT64_MAX, 0) != LZMA_OK) {
+        throw std::runtime_error("Can't initialize xz decompression");
+    }
+
+    strm.next_in = reinterpret_cast<const uint8_t *>(encodedData.data());
+    strm.avail_in = encodedData.size();
+
+    size_t total = 0;
+    lzma_ret ret;
+    do {
+        if (total == storage.size()) {
+            grow(storage);
+        }
+        strm.next_out = storage.data() + total;
+        strm.avail_out = storage.size() - total;
+
+        ret = lzma_code(&strm, LZMA_FINISH);
+        total = storage.size() - strm.avail_out;
+
+        if (ret != LZMA_OK && ret != LZMA_STREAM_END) {
+            throw std::runtime_error("Xz error: " + std::to_string(ret));
+        }
+    } while (ret != LZMA_STREAM_END);
+
+    return StringBuffer(reinterpret_cast<const char *>(storage.data()), total);
+}
+
+}
+}
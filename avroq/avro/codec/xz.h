@@ -0,0 +1,31 @@
+#ifndef __avro_codec_xz_h_
+#define __avro_codec_xz_h_
+
+#include <lzma.h>
+
+#include "codec.h"
+
+
+namespace avro {
+namespace codec {
+
+// Decoder of the stream is reused by next blocks, memory is kept
+class Xz : public Codec {
+public:
+
+    Xz();
+    Xz(const Xz &) = delete;
+    virtual ~Xz();
+
+    virtual StringBuffer decode(
+                const StringBuffer &encodedData,
+                storage_t &storage);
+
+private:
+    lzma_stream strm = LZMA_STREAM_INIT;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,91 @@
+#include <zstd.h>
+
+#include <stdexcept>
+#include <string>
+
+#include "zstandard.h"
+
+namespace avro {
+namespace codec {
+
+namespace {
+    // storage growth step when size of data is not known
+    const size_t STREAM_STEP = 4 * 1024 * 1024;
+
+    size_t check(size_t ret) {
+        if (ZSTD_isError(ret)) {
+            throw std::runtime_error(std::string("Zstandard error: ") + ZSTD_getErrorName(ret));
+        }
+        return ret;
+    }
+}
+
+Zstd::Zstd()
+    : context(ZSTD_createDCtx()) {
+    if (!context) {
+        throw std::runtime_error("Can't create Zstandard context");
+    }
+}
+
+Zstd::~Zstd() {
+    ZSTD_freeDCtx(context);
+}
+
+StringBuffer Zstd::decode(
+            const StringBuffer &encodedData,
+            storage_t &storage) {
+
+    const unsigned long long contentSize = ZSTD_getFrameContentSize(encodedData.data(), encodedData.size());
+
+    // a block could be a few frames, only the first one is looked at
+    const bool oneFrame = contentSize != ZSTD_CONTENTSIZE_UNKNOWN &&
+        contentSize != ZSTD_CONTENTSIZE_ERROR &&
+        ZSTD_findFrameCompressedSize(encodedData.data(), encodedData.size()) == encodedData.size();
+
+    if (!oneFrame) {
+        size_t size = decodeStream(encodedData, storage);
+        return StringBuffer(reinterpret_cast<const char *>(storage.data()), size);
+    }
+
+    // content size comes from the file, a block of 4 bytes at least (header
+    // and one byte repeated) makes no more than ZSTD_BLOCKSIZE_MAX of it
+    if (contentSize / (ZSTD_BLOCKSIZE_MAX / 4) > encodedData.size()) {
+        throw std::runtime_error("Zstandard frame content size " + std::to_string(contentSize) +
+                                 " is too big for " + std::to_string(encodedData.size()) + " bytes");
+    }
+
+    if (storage.size() < contentSize) {
+        storage.resize(contentSize);
+    }
+    size_t size = check(ZSTD_decompressDCtx(context, storage.data(), contentSize,
+                                            encodedData.data(), encodedData.size()));
+    if (size != contentSize) {
+        throw std::runtime_error("Zstandard frame is shorter than its content size");
+    }
+    return StringBuffer(reinterpret_cast<const char *>(storage.data()), size);
+}
+
+size_t Zstd::decodeStream(const StringBuffer &encodedData, storage_t &storage) {
+    check(ZSTD_DCtx_reset(context, ZSTD_reset_session_only));
+
+    ZSTD_inBuffer in = {encodedData.data(), encodedData.size(), 0};
+    ZSTD_outBuffer out = {storage.data(), storage.size(), 0};
+
+    size_t ret;
+    do {
+        if (out.pos == storage.size()) {
+            storage.resize(storage.size() + STREAM_STEP);
+            out.dst = storage.data();
+            out.size = storage.size();
+        }
+        ret = check(ZSTD_decompressStream(context, &out, &in));
+    } while (in.pos < in.size || (ret != 0 && out.pos == out.size));
+
+    if (ret != 0) {
+        throw std::runtime_error("Zstandard block is truncated");
+    }
+    return out.pos;
+}
+
+}
+}
@@ -0,0 +1,32 @@
+#ifndef __avro_codec_zstandard_h_
+#define __avro_codec_zstandard_h_
+
+#include "codec.h"
+
+struct ZSTD_DCtx_s;
+
+namespace avro {
+namespace codec {
+
+// Decompression context is created once and reused for every block
+class Zstd : public Codec {
+public:
+
+    Zstd();
+    Zstd(const Zstd &) = delete;
+    virtual ~Zstd();
+
+    virtual StringBuffer decode(
+                const StringBuffer &encodedData,
+                storage_t &storage);
+
+private:
+    ZSTD_DCtx_s *context;
+
+    size_t decodeStream(const StringBuffer &encodedData, storage_t &storage);
+};
+
+}
+}
+
+#endif
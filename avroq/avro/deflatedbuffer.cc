@@ -1,10 +1,19 @@
 #include <cstring>
 #include <stdexcept>
 
+#include <util/memsearch.h>
+
 #include "deflatedbuffer.h"
 
 namespace avro {
 
+namespace {
+    // Zeros after data in the window. A record cut by the end of the window
+    // reads them as empty values, loops over arrays stop at eof(), so it
+    // doesn't run out of the window before it is read again
+    const size_t WINDOW_SLACK = 64 * 1024;
+}
+
 DeflatedBuffer::DeflatedBuffer() {
 }
 
@@ -12,8 +21,67 @@ DeflatedBuffer::DeflatedBuffer() {
 void DeflatedBuffer::assignData(const StringBuffer &b) {
     c = b.data();
     length = b.size();
+    loadable = length;
     documentStartPointer = 0;
     pointer = 0;
+    source = nullptr;
+    window = nullptr;
+}
+
+void DeflatedBuffer::assignStream(source_t source, codec::storage_t &window, size_t windowSize) {
+    this->source = std::move(source);
+    this->window = &window;
+    this->windowSize = windowSize;
+    fillSize = 2 * windowSize;
+    sourceFinished = false;
+    c = nullptr;
+    length = 0;
+    loadable = 0;
+    documentStartPointer = 0;
+    pointer = 0;
+}
+
+void DeflatedBuffer::fillWindow() {
+    if (!window || sourceFinished || pointer > length || length - pointer >= windowSize) {
+        return;
+    }
+    readMore(pointer);
+}
+
+bool DeflatedBuffer::growWindow() {
+    if (!window || sourceFinished) {
+        return false;
+    }
+    pointer = documentStartPointer;
+    if (length - pointer + windowSize > fillSize) {
+        fillSize *= 2;
+    }
+    readMore(pointer);
+    return true;
+}
+
+void DeflatedBuffer::readMore(size_t from) {
+    if (window->size() < fillSize + WINDOW_SLACK) {
+        window->resize(fillSize + WINDOW_SLACK);
+    }
+    char *data = reinterpret_cast<char *>(window->data());
+
+    std::memmove(data, data + from, length - from);
+    length -= from;
+    pointer -= from;
+    documentStartPointer = documentStartPointer > from ? documentStartPointer - from : 0;
+
+    while (length < fillSize) {
+        size_t n = source(data + length, fillSize - length);
+        if (n == 0) {
+            sourceFinished = true;
+            break;
+        }
+        length += n;
+    }
+    std::memset(data + length, 0, WINDOW_SLACK);
+    c = data;
+    loadable = length + WINDOW_SLACK;
 }
 
 char DeflatedBuffer::getChar() {
@@ -23,6 +91,11 @@ char DeflatedBuffer::getChar() {
 }
 
 void DeflatedBuffer::read(void *to, size_t len) {
+    if (pointer > length || len > length - pointer) {
+        std::memset(to, 0, len);
+        pointer = length + 1;
+        return;
+    }
     std::memcpy(to, c + pointer, len);
     pointer += len;
 }
@@ -31,6 +104,13 @@ size_t DeflatedBuffer::size() {
     return length;
 }
 
+bool DeflatedBuffer::mayContain(const std::string &s) const {
+    if (source || pointer >= length) {
+        return true;
+    }
+    return util::memsearch(c + pointer, length - pointer, s.data(), s.size()) != nullptr;
+}
+
 void DeflatedBuffer::startDocument() {
     documentStartPointer = pointer;
 }
@@ -40,6 +120,10 @@ void DeflatedBuffer::resetToDocument() {
 }
 
 StringBuffer DeflatedBuffer::getString(size_t len) {
+    if (pointer > length || len > length - pointer) {
+        pointer = length + 1;
+        return StringBuffer(c + length, 0);
+    }
     StringBuffer result((const char*)c + pointer, len);
     pointer += len;
     return result;
@@ -3,17 +3,38 @@
 
 #include <vector>
 #include <cstdint>
+#include <functional>
+#include <string>
 
+#include "codec/codec.h"
 #include "stringbuffer.h"
+#include "varint.h"
+#include "zigzag.hpp"
 
 namespace avro {
 
 class DeflatedBuffer {
 public:
+    // writes up to `len' bytes of decompressed block, 0 at its end
+    using source_t = std::function<size_t(char *to, size_t len)>;
+
     DeflatedBuffer();
 
     void assignData(const StringBuffer &b);
 
+    // Block is decompressed into `window' while it is read, keeping at least
+    // `windowSize' bytes ahead of the current record
+    void assignStream(source_t source, codec::storage_t &window, size_t windowSize);
+
+    // Call before a record: moves its start to the beginning of the window
+    // and decompresses more when less than windowSize bytes are left
+    void fillWindow();
+
+    // The current record was cut by the end of the window: the window is
+    // made bigger and the record has to be read again from its start.
+    // False when there is no more data
+    bool growWindow();
+
     char getChar();
     StringBuffer getStringBuffer(size_t length);
 
@@ -22,9 +43,14 @@ public:
         pointer++;
     }
 
+    // going past the end stops right after it, so eof() is true
     inline
     void skip(size_t n) {
-        pointer += n;
+        if (pointer <= length && n <= length - pointer) {
+            pointer += n;
+        } else {
+            pointer = length + 1;
+        }
     }
 
     inline
@@ -34,8 +60,42 @@ public:
 
     void read(void *to, size_t len);
 
+    // zigzag varints, decoded by wide loads when the bytes after them can
+    // be loaded: zeros after the window, data of the whole block
+    inline
+    int64_t readZigZagLong() {
+        uint64_t value;
+        size_t n;
+        if (pointer + 8 <= loadable &&
+                varint::decode(reinterpret_cast<const uint8_t *>(c) + pointer, value, n)) {
+            pointer += n;
+            return decodeZigzag64(value);
+        }
+        return avro::readZigZagLong<DeflatedBuffer>(*this);
+    }
+
+    inline
+    void skipZigZagLongs(uint32_t count) {
+        if (pointer + 16 <= loadable) {
+            const uint8_t *data = reinterpret_cast<const uint8_t *>(c);
+            pointer = varint::skip(data + pointer, data + loadable, count) - data;
+        }
+        for(; count > 0; --count) {
+            avro::skipZigZagLong<DeflatedBuffer>(*this);
+        }
+    }
+
+    inline
+    size_t position() const {
+        return pointer;
+    }
+
     size_t size();
 
+    // false if `s' is absent from the rest of a whole block, true when the
+    // block is read by windows and its rest is not known
+    bool mayContain(const std::string &s) const;
+
     void startDocument();
 
     void resetToDocument();
@@ -46,12 +106,39 @@ private:
     const char *c = nullptr;
     size_t length = 0;
     size_t pointer = 0;
+    // bytes from `c' that can be loaded, the data and zeros after it
+    size_t loadable = 0;
 
     size_t documentStartPointer = 0;
 
+    source_t source;
+    codec::storage_t *window = nullptr;
+    size_t windowSize = 0;
+    // window is filled up to this size
+    size_t fillSize = 0;
+    bool sourceFinished = false;
+
     void decompress(const char *compressedData, size_t length);
+    // drops data before `from' and decompresses up to fillSize
+    void readMore(size_t from);
 };
 
+// varints of blocks are read by the methods above
+inline
+long readZigZagLong(DeflatedBuffer &b) {
+    return b.readZigZagLong();
+}
+
+inline
+void skipZigZagLong(DeflatedBuffer &b) {
+    b.skipZigZagLongs(1);
+}
+
+inline
+void skipZigZagLongs(DeflatedBuffer &b, uint32_t count) {
+    b.skipZigZagLongs(count);
+}
+
 }
 
 #endif /* defined(__avroq__deflatedbuffer__) */
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <avro/node/all_nodes.h>
+#include <avro/stringbuffer.h>
+#include <avro/sidecar/bloom.h>
+
+#include "tsvexpression.h"
+
+namespace avro {
+namespace dumper {
+
+// Adds fields listed in TsvExpression to Bloom filters of a block,
+// document after document
+class Bloom {
+
+public:
+    Bloom(const TsvExpression &wd, sidecar::BlockBloom &block, int64_t objectCount) : whatDump(wd), block(block) {
+        block.fields.assign(whatDump.pos, sidecar::BloomFilter(objectCount));
+    }
+
+    void addIfNecessary(uint64_t hash, const node::Node &n) {
+        auto range = whatDump.columnsOf(n.getNumber());
+        std::for_each (
+            range.first, range.second,
+            [hash, this](int position){
+                block.fields[position].add(hash);
+            }
+        );
+    }
+
+    void String(const StringBuffer &s, const node::String &n) {
+        addIfNecessary(sidecar::BloomFilter::hash(s.data(), s.size()), n);
+    }
+
+    void MapName(const StringBuffer &name) {
+    }
+
+    void MapValue(const StringBuffer &s, const node::String &n) {
+    }
+    void MapValue(int i, const node::Int &n) {
+    }
+
+    void Int(int i, const node::Int &n) {
+        addIfNecessary(sidecar::BloomFilter::hash(i), n);
+    }
+
+    void Long(long l, const node::Long &n) {
+        addIfNecessary(sidecar::BloomFilter::hash(int(l)), n);
+    }
+
+    void Float(float f, const node::Float &n) {
+    }
+
+    void Double(double d, const node::Double &n) {
+    }
+
+    void Boolean(bool b, const node::Boolean &n) {
+    }
+
+    void Null(const node::Null &n) {
+    }
+
+    void Union(int index, const node::Union &n) {
+    }
+
+    void RecordBegin(const node::Record &r) {
+    }
+
+    void RecordEnd(const node::Record &r) {
+    }
+
+    void ArrayBegin(const node::Array &a) {
+    }
+
+    void ArrayEnd(const node::Array &a) {
+    }
+
+    void CustomBegin(const node::Custom &c) {
+    }
+
+    void Enum(const node::Enum &e, int index) {
+        addIfNecessary(sidecar::BloomFilter::hash(index), e);
+    }
+
+    void MapBegin(const node::Map &m) {
+    }
+
+    void MapEnd(const node::Map &m) {
+    }
+
+private:
+    const TsvExpression &whatDump;
+    sidecar::BlockBloom &block;
+};
+
+}
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <avro/node/all_nodes.h>
+#include <avro/stringbuffer.h>
+#include <avro/sidecar/stats.h>
+
+#include "tsvexpression.h"
+
+namespace avro {
+namespace dumper {
+
+// Collects ranges of fields listed in TsvExpression into BlockStats,
+// document after document
+class Stats {
+
+public:
+    Stats(const TsvExpression &wd, sidecar::BlockStats &block) : whatDump(wd), block(block) {
+        block.fields.resize(whatDump.pos);
+    }
+
+    template<typename T, typename NodeType>
+    void addIfNecessary(const T &t, const NodeType &n) {
+        auto range = whatDump.columnsOf(n.getNumber());
+        std::for_each (
+            range.first, range.second,
+            [&t, this](int position){
+                block.fields[position].add(t);
+            }
+        );
+    }
+
+    void String(const StringBuffer &s, const node::String &n) {
+        addIfNecessary(s, n);
+    }
+
+    void MapName(const StringBuffer &name) {
+    }
+
+    void MapValue(const StringBuffer &s, const node::String &n) {
+    }
+    void MapValue(int i, const node::Int &n) {
+    }
+
+    void Int(int i, const node::Int &n) {
+        addIfNecessary(int64_t(i), n);
+    }
+
+    void Long(long l, const node::Long &n) {
+        addIfNecessary(int64_t(l), n);
+    }
+
+    void Float(float f, const node::Float &n) {
+        addIfNecessary(double(f), n);
+    }
+
+    void Double(double d, const node::Double &n) {
+        addIfNecessary(d, n);
+    }
+
+    void Boolean(bool b, const node::Boolean &n) {
+        addIfNecessary(int64_t(b), n);
+    }
+
+    void Null(const node::Null &n) {
+        auto range = whatDump.columnsOf(n.getNumber());
+        std::for_each (
+            range.first, range.second,
+            [this](int position){
+                block.fields[position].addNull();
+            }
+        );
+    }
+
+    void Union(int index, const node::Union &n) {
+    }
+
+    void RecordBegin(const node::Record &r) {
+    }
+
+    void RecordEnd(const node::Record &r) {
+    }
+
+    void ArrayBegin(const node::Array &a) {
+    }
+
+    void ArrayEnd(const node::Array &a) {
+    }
+
+    void CustomBegin(const node::Custom &c) {
+    }
+
+    void Enum(const node::Enum &e, int index) {
+        addIfNecessary(int64_t(index), e);
+    }
+
+    void MapBegin(const node::Map &m) {
+    }
+
+    void MapEnd(const node::Map &m) {
+    }
+
+private:
+    const TsvExpression &whatDump;
+    sidecar::BlockStats &block;
+};
+
+}
+}
@@ -55,12 +55,12 @@ public:
 
     template<typename T, typename NodeType>
     void addIfNecessary(const T &t, const NodeType &n) {
-        auto range = whatDump.what.equal_range(n.getNumber());
+        auto range = whatDump.columnsOf(n.getNumber());
         if (range.first != range.second) {
-            for_each (
+            std::for_each (
                 range.first, range.second,
-                [&t, this](const auto &item){
-                    toDump[item.second].reset(new TDumper<T>(t));
+                [&t, this](int position){
+                    toDump[position].reset(new TDumper<T>(t));
                 }
             );
     	}
@@ -1,16 +1,54 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
 #include <unordered_map>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace avro {
 namespace dumper {
 
 struct TsvExpression {
     using map_t = std::unordered_multimap<int, int>;
+    using columns_t = std::pair<const int *, const int *>;
+
+    // node number to positions in the output
     map_t what;
     int pos = 0;
     std::string fieldSeparator;
+
+    // `what' laid out by node numbers: positions of node N are
+    // columns[firstColumn[N]] up to columns[firstColumn[N + 1]]
+    std::vector<uint32_t> firstColumn;
+    std::vector<int> columns;
+
+    void index(int nodesNumber) {
+        for(const auto &item : what) {
+            nodesNumber = std::max(nodesNumber, item.first + 1);
+        }
+        firstColumn.assign(nodesNumber + 1, 0);
+        for(const auto &item : what) {
+            firstColumn[item.first + 1]++;
+        }
+        for(int n = 0; n < nodesNumber; ++n) {
+            firstColumn[n + 1] += firstColumn[n];
+        }
+        columns.resize(what.size());
+        std::vector<uint32_t> next(firstColumn.begin(), firstColumn.end() - 1);
+        for(const auto &item : what) {
+            columns[next[item.first]++] = item.second;
+        }
+    }
+
+    columns_t columnsOf(int number) const {
+        if (number < 0 || size_t(number) + 1 >= firstColumn.size()) {
+            return columns_t(nullptr, nullptr);
+        }
+        return columns_t(columns.data() + firstColumn[number],
+                         columns.data() + firstColumn[number + 1]);
+    }
 };
 
 }
@@ -18,16 +18,23 @@ FileException::FileException(const std::string &msg) : std::runtime_error(msg) {
 
 FileHandle::FileHandle(const std::string &filename) :filename(filename) {
 
-    struct stat st;
-    stat(filename.c_str(), &st);
-    fileLength = st.st_size;
-
-    fd = open(filename.c_str(), O_RDONLY);
+    if (filename == "-") {
+        fd = STDIN_FILENO;
+        ownDescriptor = false;
+    } else {
+        fd = open(filename.c_str(), O_RDONLY);
+    }
 
     if (fd < 0) {
         throw FileException(std::string("Can't open file '") + filename + "': " + strerror(errno));
     }
 
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        throw FileException(std::string("Can't stat file '") + filename + "': " + strerror(errno));
+    }
+    regularFile = S_ISREG(st.st_mode);
+    fileLength = st.st_size;
 
 }
 
@@ -37,7 +44,7 @@ FileHandle::~FileHandle() {
         assert(res == 0);
         mmappedFile = nullptr;
     }
-    if (fd != -1) {
+    if (fd != -1 && ownDescriptor) {
         close(fd);
     }
 }
@@ -46,6 +53,18 @@ const std::string &FileHandle::fileName() const {
     return filename;
 }
 
+int FileHandle::descriptor() const {
+    return fd;
+}
+
+bool FileHandle::isRegularFile() const {
+    return regularFile;
+}
+
+size_t FileHandle::size() const {
+    return fileLength;
+}
+
 std::unique_ptr<StringBuffer> FileHandle::mmapFile() {
 
     size_t len = (fileLength/4096 + 1) * 4096;
@@ -2,6 +2,7 @@
 #ifndef __avroq__filehandler__
 #define __avroq__filehandler__
 
+#include <cstddef>
 #include <string>
 #include <memory>
 #include <stdexcept>
@@ -17,6 +18,7 @@ public:
 
 class FileHandle {
 public:
+    // "-" stands for standard input
     explicit FileHandle(const std::string &filename);
     FileHandle(const FileHandle &) = delete;
     FileHandle() = delete;
@@ -25,10 +27,19 @@ public:
 
     const std::string &fileName() const;
 
+    int descriptor() const;
+
+    // false for pipes, sockets, terminals: such files can't be mmapped
+    bool isRegularFile() const;
+
+    size_t size() const;
+
     std::unique_ptr<StringBuffer> mmapFile();
 private:
     int fd = -1;
-    int fileLength = 0;
+    size_t fileLength = 0;
+    bool regularFile = false;
+    bool ownDescriptor = true;
     std::string filename;
     const char *mmappedFile = nullptr;
 };
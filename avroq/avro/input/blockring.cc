@@ -0,0 +1,36 @@
+#include "blockring.h"
+
+namespace avro {
+namespace input {
+
+BlockRing::BlockRing(size_t slots)
+    : buffers(slots) {
+    for(size_t i = slots; i > 0; --i) {
+        freeSlots.push_back(i - 1);
+    }
+}
+
+size_t BlockRing::acquire() {
+    std::unique_lock<std::mutex> lock(m);
+
+    while (freeSlots.empty()) {
+        released.wait(lock);
+    }
+
+    size_t slot = freeSlots.back();
+    freeSlots.pop_back();
+    return slot;
+}
+
+void BlockRing::release(size_t slot) {
+    std::unique_lock<std::mutex> lock(m);
+    freeSlots.push_back(slot);
+    released.notify_one();
+}
+
+std::vector<char> &BlockRing::operator[](size_t slot) {
+    return buffers[slot];
+}
+
+}
+}
@@ -0,0 +1,35 @@
+#ifndef __avro_input_blockring_h_
+#define __avro_input_blockring_h_
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+namespace avro {
+namespace input {
+
+/*
+ * Fixed set of reusable block buffers. Producer waits in acquire() while
+ * all of them are in flight, so memory is bounded by number of slots
+ * rather than by input size.
+ */
+class BlockRing {
+public:
+    explicit BlockRing(size_t slots);
+
+    size_t acquire();
+    void release(size_t slot);
+
+    std::vector<char> &operator[](size_t slot);
+
+private:
+    std::vector<std::vector<char>> buffers;
+    std::vector<size_t> freeSlots;
+    std::mutex m;
+    std::condition_variable released;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,29 @@
+#include <avro/filehandler.h>
+
+#include "mmap.h"
+#include "stream.h"
+#include "tail.h"
+
+#include "create.h"
+
+namespace avro {
+namespace input {
+
+namespace {
+    // Upper bound of blocks read from a pipe but not yet processed by workers
+    const size_t STREAM_BLOCKS_IN_FLIGHT = 32;
+}
+
+std::unique_ptr<Input> createForFile(FileHandle &file, const Options &options) {
+    if (file.isRegularFile() && options.follow) {
+        return std::unique_ptr<Input>(new Tail(file));
+    }
+    if (file.isRegularFile()) {
+        return std::unique_ptr<Input>(new Mmap(file, options));
+    }
+    return std::unique_ptr<Input>(new Stream(file, STREAM_BLOCKS_IN_FLIGHT));
+}
+
+
+}
+}
@@ -0,0 +1,19 @@
+#include <memory>
+
+#include "input.h"
+#include "options.h"
+
+
+namespace avro {
+
+class FileHandle;
+
+namespace input {
+
+
+// mmap for regular files, sequential reading for pipes and stdin
+std::unique_ptr<Input> createForFile(FileHandle &file, const Options &options);
+
+
+}
+}
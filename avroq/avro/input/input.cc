@@ -0,0 +1,29 @@
+#include <stdexcept>
+
+#include "input.h"
+
+namespace avro {
+namespace input {
+
+Input::~Input() {
+}
+
+std::shared_ptr<StringBuffer> Input::getBlockAt(size_t, size_t) {
+    throw std::runtime_error("Input doesn't support random access");
+}
+
+const StringBuffer *Input::whole() const {
+    return nullptr;
+}
+
+std::string Input::getStdString(size_t len) {
+    std::string result;
+    result.resize(len);
+
+    read(&result[0], len);
+
+    return result;
+}
+
+}
+}
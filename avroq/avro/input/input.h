@@ -0,0 +1,46 @@
+#ifndef __avro_input_input_h_
+#define __avro_input_input_h_
+
+#include <memory>
+#include <string>
+
+#include <avro/stringbuffer.h>
+
+namespace avro {
+namespace input {
+
+/*
+ * Source of bytes for avro::Reader. Header and block framing are read
+ * byte-by-byte, block payloads are taken as a whole by getBlock().
+ */
+class Input {
+public:
+
+    virtual ~Input();
+
+    virtual char getChar() = 0;
+    virtual void read(void *to, size_t len) = 0;
+    virtual bool eof() = 0;
+
+    // Block data stays valid while returned buffer is alive.
+    // Returns empty pointer if input is shorter than `len'
+    virtual std::shared_ptr<StringBuffer> getBlock(size_t len) = 0;
+
+    // Block at a known offset, for regular files only.
+    // Returns empty pointer if input is shorter
+    virtual std::shared_ptr<StringBuffer> getBlockAt(size_t offset, size_t len);
+
+    // Number of bytes read so far
+    virtual size_t position() const = 0;
+
+    // Whole input at once if it's mapped into memory, nullptr otherwise.
+    // Unread part of the buffer starts at the current reading position
+    virtual const StringBuffer *whole() const;
+
+    std::string getStdString(size_t len);
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,183 @@
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <avro/filehandler.h>
+
+#include "mmap.h"
+
+namespace avro {
+namespace input {
+
+namespace {
+    // smaller read ahead requests are not worth a context switch
+    const size_t MIN_PREFETCH = 256 * 1024;
+
+    size_t pageSize() {
+        static const size_t size = sysconf(_SC_PAGESIZE);
+        return size;
+    }
+}
+
+// Pages of [offset, offset + len) of the file are in use while it's alive
+class Mmap::Window {
+public:
+    Window(const char *addr, size_t len, int fd, size_t offset)
+        : addr(addr), len(len), fd(fd), offset(offset) {
+    }
+
+    ~Window() {
+        // mapping is private and read only, so pages are just thrown away
+        (void)madvise(const_cast<char*>(addr), len, MADV_DONTNEED);
+        (void)posix_fadvise(fd, offset, len, POSIX_FADV_DONTNEED);
+    }
+
+private:
+    const char *addr;
+    size_t len;
+    int fd;
+    size_t offset;
+};
+
+Mmap::Mmap(FileHandle &file, const Options &options)
+    : input(file.mmapFile()),
+      fd(file.descriptor()),
+      windowSize(0),
+      prefetcher(options.prefetcher),
+      prefetchBlocks(options.prefetchBlocks) {
+
+    if (prefetcher && prefetchBlocks > 0) {
+        prefetchFd = std::make_shared<Prefetcher::Descriptor>(fd);
+    }
+
+    if (options.mmapWindow > 0) {
+        // windows have to be page aligned to be released
+        windowSize = (options.mmapWindow + pageSize() - 1) / pageSize() * pageSize();
+        windows.resize(input->size() / windowSize + 1);
+
+        (void)madvise(const_cast<char*>(input->data()), input->size(), MADV_SEQUENTIAL);
+        (void)posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+        current = pinWindow(0);
+    }
+}
+
+Mmap::~Mmap() {
+}
+
+char Mmap::getChar() {
+    return input->getChar();
+}
+
+void Mmap::read(void *to, size_t len) {
+    if (len > input->bytesLeft()) {
+        throw std::runtime_error("Unexpected end of file");
+    }
+    input->read(to, len);
+}
+
+bool Mmap::eof() {
+    return input->eof();
+}
+
+std::shared_ptr<StringBuffer> Mmap::getBlock(size_t len) {
+    if (len > input->bytesLeft()) {
+        return std::shared_ptr<StringBuffer>();
+    }
+
+    const size_t offset = position();
+    input->getAndSkip(len);
+    auto block = slice(offset, len);
+
+    if (windowSize > 0) {
+        if (input->eof()) {
+            current.reset();
+        } else {
+            current = pinWindow(position() / windowSize);
+        }
+    }
+    return block;
+}
+
+std::shared_ptr<StringBuffer> Mmap::getBlockAt(size_t offset, size_t len) {
+    if (offset > input->size() || len > input->size() - offset) {
+        return std::shared_ptr<StringBuffer>();
+    }
+    return slice(offset, len);
+}
+
+size_t Mmap::position() const {
+    return input->size() - input->bytesLeft();
+}
+
+std::shared_ptr<StringBuffer> Mmap::slice(size_t offset, size_t len) {
+    const char *data = input->data() + offset;
+
+    if (prefetchFd) {
+        prefetchAfter(offset + len, len);
+    }
+
+    if (windowSize == 0) {
+        return std::make_shared<StringBuffer>(data, len);
+    }
+
+    std::vector<std::shared_ptr<Window>> pinned;
+    const size_t last = (offset + std::max<size_t>(len, 1) - 1) / windowSize;
+    for(size_t n = offset / windowSize; n <= last; ++n) {
+        pinned.push_back(pinWindow(n));
+    }
+
+    return std::shared_ptr<StringBuffer>(
+        new StringBuffer(data, len),
+        [pinned](StringBuffer *b) {
+            delete b;
+        }
+    );
+}
+
+std::shared_ptr<Mmap::Window> Mmap::pinWindow(size_t n) {
+    auto window = windows[n].lock();
+    if (!window) {
+        const size_t offset = n * windowSize;
+        const size_t len = std::min(windowSize, input->size() - offset);
+        window = std::make_shared<Window>(input->data() + offset, len, fd, offset);
+        windows[n] = window;
+
+        if (n == 0) {
+            adviseWillNeed(n);
+        }
+        // the next one is going to be read soon
+        adviseWillNeed(n + 1);
+    }
+    return window;
+}
+
+void Mmap::adviseWillNeed(size_t n) {
+    const size_t offset = n * windowSize;
+    if (offset >= input->size()) {
+        return;
+    }
+    const size_t len = std::min(windowSize, input->size() - offset);
+    (void)madvise(const_cast<char*>(input->data() + offset), len, MADV_WILLNEED);
+}
+
+void Mmap::prefetchAfter(size_t offset, size_t blockSize) {
+    const size_t from = std::max(offset, prefetchedUntil);
+    const size_t until = std::min(input->size(), offset + prefetchBlocks * blockSize);
+
+    if (until <= from || (until - from < MIN_PREFETCH && until != input->size())) {
+        return;
+    }
+    prefetcher->range(prefetchFd, from, until - from);
+    prefetchedUntil = until;
+}
+
+const StringBuffer *Mmap::whole() const {
+    return input.get();
+}
+
+}
+}
@@ -0,0 +1,61 @@
+#ifndef __avro_input_mmap_h_
+#define __avro_input_mmap_h_
+
+#include <vector>
+
+#include "input.h"
+#include "options.h"
+#include "prefetcher.h"
+
+namespace avro {
+
+class FileHandle;
+
+namespace input {
+
+/*
+ * Whole file mapped into memory. With non-zero `window' the mapping is
+ * split into windows of that size: a window is advised to be read ahead
+ * when reading comes close to it, and its pages are dropped from memory
+ * and page cache as soon as reading has left it and the last block
+ * referencing it is released.
+ * With a prefetcher bytes of next blocks are read in background.
+ */
+class Mmap : public Input {
+public:
+    Mmap(FileHandle &file, const Options &options);
+    virtual ~Mmap();
+
+    virtual char getChar();
+    virtual void read(void *to, size_t len);
+    virtual bool eof();
+    virtual std::shared_ptr<StringBuffer> getBlock(size_t len);
+    virtual std::shared_ptr<StringBuffer> getBlockAt(size_t offset, size_t len);
+    virtual size_t position() const;
+    virtual const StringBuffer *whole() const;
+
+private:
+    class Window;
+
+    std::unique_ptr<StringBuffer> input;
+    int fd;
+    size_t windowSize;
+    std::vector<std::weak_ptr<Window>> windows;
+    // window under the read position, not released while reading goes on in it
+    std::shared_ptr<Window> current;
+
+    std::shared_ptr<Prefetcher> prefetcher;
+    std::shared_ptr<Prefetcher::Descriptor> prefetchFd;
+    size_t prefetchBlocks;
+    size_t prefetchedUntil = 0;
+
+    std::shared_ptr<StringBuffer> slice(size_t offset, size_t len);
+    std::shared_ptr<Window> pinWindow(size_t n);
+    void adviseWillNeed(size_t n);
+    void prefetchAfter(size_t offset, size_t blockSize);
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef __avro_input_options_h_
+#define __avro_input_options_h_
+
+#include <cstddef>
+#include <memory>
+
+namespace avro {
+namespace input {
+
+class Prefetcher;
+
+struct Options {
+    // Release pages of a mmapped file by windows of this size once they are
+    // read and processed. 0 keeps the whole file mapped and cached
+    size_t mmapWindow = 0;
+
+    // Bytes of that many blocks of the current size are read ahead in background
+    size_t prefetchBlocks = 0;
+    std::shared_ptr<Prefetcher> prefetcher;
+
+    // Regular files are expected to grow, see Tail
+    bool follow = false;
+};
+
+}
+}
+
+#endif
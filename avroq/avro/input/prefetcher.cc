@@ -0,0 +1,101 @@
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+
+#include "prefetcher.h"
+
+namespace avro {
+namespace input {
+
+namespace {
+    // enough for the header and first blocks, the rest is read ahead by blocks
+    const size_t FILE_HEAD = 4 * 1024 * 1024;
+}
+
+Prefetcher::Descriptor::Descriptor(int fd)
+    : fd(dup(fd)) {
+}
+
+Prefetcher::Descriptor::~Descriptor() {
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+int Prefetcher::Descriptor::get() const {
+    return fd;
+}
+
+Prefetcher::Prefetcher(size_t maxPending)
+    : maxPending(maxPending),
+      worker([this]() { run(); }) {
+}
+
+Prefetcher::~Prefetcher() {
+    {
+        std::unique_lock<std::mutex> lock(m);
+        stop = true;
+        added.notify_one();
+    }
+    worker.join();
+}
+
+void Prefetcher::file(const std::string &filename) {
+    if (filename == "-") {
+        return;
+    }
+    push([filename]() {
+        // open() itself may take a while on network file systems
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+            (void)posix_fadvise(fd, 0, std::min<size_t>(st.st_size, FILE_HEAD), POSIX_FADV_WILLNEED);
+        }
+        close(fd);
+    });
+}
+
+void Prefetcher::range(std::shared_ptr<Descriptor> fd, size_t offset, size_t len) {
+    if (fd->get() < 0) {
+        return;
+    }
+    push([fd, offset, len]() {
+        (void)posix_fadvise(fd->get(), offset, len, POSIX_FADV_WILLNEED);
+    });
+}
+
+void Prefetcher::push(job_t job) {
+    std::unique_lock<std::mutex> lock(m);
+    if (jobs.size() >= maxPending) {
+        return;
+    }
+    jobs.push_back(std::move(job));
+    added.notify_one();
+}
+
+void Prefetcher::run() {
+    while (true) {
+        job_t job;
+        {
+            std::unique_lock<std::mutex> lock(m);
+            while (jobs.empty() && !stop) {
+                added.wait(lock);
+            }
+            if (stop) {
+                return;
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        // submitting reads may block, that's why it's done here
+        job();
+    }
+}
+
+}
+}
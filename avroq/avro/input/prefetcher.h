@@ -0,0 +1,58 @@
+#ifndef __avro_input_prefetcher_h_
+#define __avro_input_prefetcher_h_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace avro {
+namespace input {
+
+/*
+ * Background thread asking the kernel to read data which is going to be
+ * needed soon: beginnings of the next files and bytes ahead of the
+ * current block. Requests are only hints, they are dropped when the
+ * thread can't keep up.
+ */
+class Prefetcher {
+public:
+
+    // Own copy of a file descriptor, so a request stays valid after the
+    // file is closed by the reader
+    class Descriptor {
+    public:
+        explicit Descriptor(int fd);
+        ~Descriptor();
+        int get() const;
+    private:
+        int fd;
+    };
+
+    explicit Prefetcher(size_t maxPending);
+    ~Prefetcher();
+
+    void file(const std::string &filename);
+    void range(std::shared_ptr<Descriptor> fd, size_t offset, size_t len);
+
+private:
+    using job_t = std::function<void()>;
+
+    size_t maxPending;
+    std::deque<job_t> jobs;
+    bool stop = false;
+    std::mutex m;
+    std::condition_variable added;
+    std::thread worker;
+
+    void push(job_t job);
+    void run();
+};
+
+}
+}
+
+#endif
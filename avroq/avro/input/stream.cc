@@ -0,0 +1,131 @@
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+
+#include <stdexcept>
+
+#include <avro/filehandler.h>
+
+#include "blockring.h"
+#include "stream.h"
+
+namespace avro {
+namespace input {
+
+namespace {
+    const size_t READ_CHUNK = 1024 * 1024;
+}
+
+Stream::Stream(FileHandle &file, size_t blocksInFlight)
+    : fd(file.descriptor()),
+      buffer(READ_CHUNK),
+      ring(std::make_shared<BlockRing>(blocksInFlight)) {
+#ifdef F_SETPIPE_SZ
+    // default 64K pipe makes writer and reader wake up each other too often
+    (void)fcntl(fd, F_SETPIPE_SZ, READ_CHUNK);
+#endif
+}
+
+Stream::~Stream() {
+}
+
+size_t Stream::readFd(char *to, size_t len) {
+    while (true) {
+        ssize_t res = ::read(fd, to, len);
+        if (res >= 0) {
+            return res;
+        }
+        if (errno != EINTR) {
+            throw std::runtime_error(std::string("Can't read input: ") + strerror(errno));
+        }
+    }
+}
+
+bool Stream::fill() {
+    if (finished) {
+        return false;
+    }
+    consumed += end;
+    begin = 0;
+    end = readFd(buffer.data(), buffer.size());
+    if (end == 0) {
+        finished = true;
+    }
+    return !finished;
+}
+
+// copies buffered bytes first, then reads the rest bypassing the buffer
+size_t Stream::readAvailable(char *to, size_t len) {
+    size_t done = std::min(len, end - begin);
+    memcpy(to, buffer.data() + begin, done);
+    begin += done;
+
+    while (done < len && !finished) {
+        if (len - done < buffer.size()) {
+            if (!fill()) {
+                break;
+            }
+            size_t n = std::min(len - done, end - begin);
+            memcpy(to + done, buffer.data() + begin, n);
+            begin += n;
+            done += n;
+        } else {
+            size_t n = readFd(to + done, len - done);
+            if (n == 0) {
+                finished = true;
+            }
+            consumed += n;
+            done += n;
+        }
+    }
+    return done;
+}
+
+char Stream::getChar() {
+    if (begin == end && !fill()) {
+        throw std::runtime_error("Unexpected end of input");
+    }
+    return buffer[begin++];
+}
+
+void Stream::read(void *to, size_t len) {
+    if (readAvailable(static_cast<char*>(to), len) != len) {
+        throw std::runtime_error("Unexpected end of input");
+    }
+}
+
+bool Stream::eof() {
+    return begin == end && !fill();
+}
+
+size_t Stream::position() const {
+    return consumed + begin;
+}
+
+std::shared_ptr<StringBuffer> Stream::getBlock(size_t len) {
+
+    size_t slot = ring->acquire();
+    auto &data = (*ring)[slot];
+
+    if (data.size() < len) {
+        data.resize(len);
+    }
+
+    if (readAvailable(data.data(), len) != len) {
+        ring->release(slot);
+        return std::shared_ptr<StringBuffer>();
+    }
+
+    auto owner = ring;
+    return std::shared_ptr<StringBuffer>(
+        new StringBuffer(data.data(), len),
+        [owner, slot](StringBuffer *b) {
+            delete b;
+            owner->release(slot);
+        }
+    );
+}
+
+}
+}
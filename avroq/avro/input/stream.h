@@ -0,0 +1,49 @@
+#ifndef __avro_input_stream_h_
+#define __avro_input_stream_h_
+
+#include <vector>
+
+#include "input.h"
+
+namespace avro {
+
+class FileHandle;
+
+namespace input {
+
+class BlockRing;
+
+/*
+ * Sequential reading from a file descriptor (pipe, socket, stdin).
+ * Blocks are copied into buffers of a BlockRing: no more than `blocksInFlight'
+ * blocks are held at the same time.
+ */
+class Stream : public Input {
+public:
+    Stream(FileHandle &file, size_t blocksInFlight);
+    virtual ~Stream();
+
+    virtual char getChar();
+    virtual void read(void *to, size_t len);
+    virtual bool eof();
+    virtual std::shared_ptr<StringBuffer> getBlock(size_t len);
+    virtual size_t position() const;
+
+private:
+    int fd;
+    std::vector<char> buffer;
+    size_t begin = 0;
+    size_t end = 0;
+    bool finished = false;
+    size_t consumed = 0; // bytes before the buffer
+    std::shared_ptr<BlockRing> ring;
+
+    bool fill();
+    size_t readFd(char *to, size_t len);
+    size_t readAvailable(char *to, size_t len);
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,166 @@
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <stdexcept>
+
+#include <avro/filehandler.h>
+
+#include "tail.h"
+
+namespace avro {
+namespace input {
+
+namespace {
+    size_t pageSize() {
+        static const size_t size = sysconf(_SC_PAGESIZE);
+        return size;
+    }
+}
+
+// Mapping of [start, end) of the file, start is page aligned
+class Tail::Region {
+public:
+    Region(int fd, size_t start, size_t end, const std::string &fileName)
+        : start(start), len(end - start) {
+        if (len == 0) {
+            return;
+        }
+        addr = static_cast<const char *>(mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, start));
+        if (addr == MAP_FAILED) {
+            throw FileException("Can't mmap file '" + fileName + "': " + strerror(errno));
+        }
+        (void)madvise(const_cast<char*>(addr), len, MADV_SEQUENTIAL);
+    }
+
+    ~Region() {
+        if (addr) {
+            (void)munmap(const_cast<char*>(addr), len);
+        }
+    }
+
+    const char *at(size_t offset) const {
+        return addr + (offset - start);
+    }
+
+private:
+    const char *addr = nullptr;
+    size_t start;
+    size_t len;
+};
+
+Tail::Tail(FileHandle &file)
+    : fd(file.descriptor()),
+      fileName(file.fileName()) {
+
+    // without inotify the file is just polled
+    notifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (notifyFd >= 0 && inotify_add_watch(notifyFd, fileName.c_str(), IN_MODIFY | IN_CLOSE_WRITE) < 0) {
+        close(notifyFd);
+        notifyFd = -1;
+    }
+
+    mapFrom(0, currentSize());
+}
+
+Tail::~Tail() {
+    if (notifyFd >= 0) {
+        close(notifyFd);
+    }
+}
+
+char Tail::getChar() {
+    if (pointer >= mappedEnd) {
+        throw std::runtime_error("Unexpected end of file");
+    }
+    return *region->at(pointer++);
+}
+
+void Tail::read(void *to, size_t len) {
+    if (len > unreadSize()) {
+        throw std::runtime_error("Unexpected end of file");
+    }
+    memcpy(to, unread(), len);
+    pointer += len;
+}
+
+bool Tail::eof() {
+    return pointer >= mappedEnd;
+}
+
+std::shared_ptr<StringBuffer> Tail::getBlock(size_t len) {
+    if (len > unreadSize()) {
+        return std::shared_ptr<StringBuffer>();
+    }
+
+    const char *data = unread();
+    pointer += len;
+
+    // block keeps its mapping alive after the next one is made
+    auto pinned = region;
+    return std::shared_ptr<StringBuffer>(
+        new StringBuffer(data, len),
+        [pinned](StringBuffer *b) {
+            delete b;
+        }
+    );
+}
+
+size_t Tail::position() const {
+    return pointer;
+}
+
+const char *Tail::unread() const {
+    return region->at(pointer);
+}
+
+size_t Tail::unreadSize() const {
+    return mappedEnd - pointer;
+}
+
+bool Tail::waitForGrowth(int timeoutMs) {
+    size_t size = currentSize();
+    if (size == mappedEnd) {
+        struct pollfd p = {notifyFd, POLLIN, 0};
+        int res = poll(&p, notifyFd >= 0 ? 1 : 0, timeoutMs);
+        if (res > 0) {
+            // events themselves don't matter, the size does
+            char events[4096];
+            while (::read(notifyFd, events, sizeof events) > 0) {
+                ;
+            }
+        }
+        size = currentSize();
+    }
+
+    if (size < mappedEnd) {
+        throw std::runtime_error("File " + fileName + " was truncated while being followed");
+    }
+    if (size == mappedEnd) {
+        return false;
+    }
+
+    mapFrom(pointer, size);
+    return true;
+}
+
+size_t Tail::currentSize() const {
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        throw FileException("Can't stat file '" + fileName + "': " + strerror(errno));
+    }
+    return st.st_size;
+}
+
+void Tail::mapFrom(size_t offset, size_t end) {
+    const size_t start = offset / pageSize() * pageSize();
+    region = std::make_shared<Region>(fd, start, end, fileName);
+    mappedEnd = end;
+}
+
+}
+}
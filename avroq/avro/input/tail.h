@@ -0,0 +1,57 @@
+#ifndef __avro_input_tail_h_
+#define __avro_input_tail_h_
+
+#include <string>
+
+#include "input.h"
+
+namespace avro {
+
+class FileHandle;
+
+namespace input {
+
+/*
+ * Regular file which is still being appended to. Only the part of the file
+ * which is not read yet is mapped; when the file grows the new part is
+ * mapped separately, the old mapping is released with the last block
+ * referencing it.
+ */
+class Tail : public Input {
+public:
+    explicit Tail(FileHandle &file);
+    virtual ~Tail();
+
+    virtual char getChar();
+    virtual void read(void *to, size_t len);
+    virtual bool eof();
+    virtual std::shared_ptr<StringBuffer> getBlock(size_t len);
+    virtual size_t position() const;
+
+    // Mapped bytes which are not read yet
+    const char *unread() const;
+    size_t unreadSize() const;
+
+    // Waits up to `timeoutMs' for the file to grow and maps the new part.
+    // false if it didn't grow
+    bool waitForGrowth(int timeoutMs);
+
+private:
+    class Region;
+
+    int fd;
+    std::string fileName;
+    int notifyFd = -1;
+
+    std::shared_ptr<Region> region;
+    size_t pointer = 0; // file offset of reading position
+    size_t mappedEnd = 0;
+
+    size_t currentSize() const;
+    void mapFrom(size_t offset, size_t end);
+};
+
+}
+}
+
+#endif
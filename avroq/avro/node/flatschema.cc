@@ -0,0 +1,138 @@
+#include <stdexcept>
+
+#include "all_nodes.h"
+
+#include "flatschema.h"
+
+namespace avro {
+namespace node {
+
+namespace {
+
+    FlatSchema::Type typeOf(const Node &node) {
+        using Type = FlatSchema::Type;
+
+        if (node.is<Record>()) {
+            return Type::RECORD;
+        } else if (node.is<Union>()) {
+            return Type::UNION;
+        } else if (node.is<Array>()) {
+            return Type::ARRAY;
+        } else if (node.is<Map>()) {
+            return Type::MAP;
+        } else if (node.is<Enum>()) {
+            return Type::ENUM;
+        } else if (node.is<String>()) {
+            return Type::STRING;
+        } else if (node.is<Int>()) {
+            return Type::INT;
+        } else if (node.is<Long>()) {
+            return Type::LONG;
+        } else if (node.is<Float>()) {
+            return Type::FLOAT;
+        } else if (node.is<Double>()) {
+            return Type::DOUBLE;
+        } else if (node.is<Boolean>()) {
+            return Type::BOOLEAN;
+        } else if (node.is<Null>()) {
+            return Type::NULL_;
+        } else if (node.is<Custom>()) {
+            return Type::CUSTOM;
+        }
+        throw std::runtime_error("Can't read type '" + node.getTypeName() + "' of '" + node.getItemName() + "'");
+    }
+
+}
+
+FlatSchema::FlatSchema(const Node &root) {
+    add(&root);
+}
+
+uint32_t FlatSchema::indexOf(const Node *node) const {
+    return byNode.at(node);
+}
+
+uint32_t FlatSchema::add(const Node *node) {
+    Item item;
+    item.node = node;
+    if (node->is<Custom>()) {
+        item.custom = &node->as<Custom>();
+        item.node = item.custom->getDefinition().get();
+    }
+    item.type = typeOf(*item.node);
+
+    std::vector<const Node *> nested;
+    switch (item.type) {
+        case Type::RECORD:
+            for(const auto &c : item.node->as<Record>().getChildren()) {
+                nested.push_back(c.get());
+            }
+            break;
+        case Type::UNION:
+            for(const auto &c : item.node->as<Union>().getChildren()) {
+                nested.push_back(c.get());
+            }
+            break;
+        case Type::ARRAY:
+            nested.push_back(item.node->as<Array>().getItemsType().get());
+            break;
+        case Type::MAP:
+            nested.push_back(item.node->as<Map>().getItemsType().get());
+            break;
+        case Type::CUSTOM:
+            nested.push_back(item.node);
+            break;
+        case Type::NULL_:
+            item.fixedSize = 0;
+            break;
+        case Type::BOOLEAN:
+            item.fixedSize = 1;
+            break;
+        case Type::FLOAT:
+            item.fixedSize = 4;
+            break;
+        case Type::DOUBLE:
+            item.fixedSize = 8;
+            break;
+        default:
+            break;
+    }
+
+    const uint32_t index = items.size();
+    items.push_back(item);
+    byNode[node] = index;
+
+    std::vector<uint32_t> added;
+    for(auto n : nested) {
+        added.push_back(add(n));
+    }
+    items[index].firstChild = children.size();
+    items[index].childCount = added.size();
+    children.insert(children.end(), added.begin(), added.end());
+
+    // a record of fixed size fields is skipped at once
+    if (item.type == Type::RECORD) {
+        int32_t size = 0;
+        for(auto i : added) {
+            if (items[i].fixedSize == VARIABLE) {
+                size = VARIABLE;
+                break;
+            }
+            size += items[i].fixedSize;
+        }
+        items[index].fixedSize = size;
+    }
+
+    // the definition is taken alone too, without the name of the Custom
+    if (item.custom && item.type != Type::CUSTOM) {
+        Item definition = items[index];
+        definition.custom = nullptr;
+        byNode[definition.node] = items.size();
+        items.push_back(definition);
+    }
+
+    return index;
+}
+
+}
+}
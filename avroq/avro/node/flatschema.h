@@ -0,0 +1,81 @@
+#ifndef __avroq__node_flatschema__
+#define __avroq__node_flatschema__
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace avro {
+namespace node {
+
+class Node;
+class Custom;
+
+/*
+ * Schema tree laid out in one array for decoding. Nodes are told apart by
+ * a tag instead of dynamic_cast, children of a node are a range of the
+ * children array, Custom wrappers are resolved into their definitions.
+ */
+class FlatSchema {
+public:
+    enum class Type : uint8_t {
+        RECORD,
+        UNION,
+        ARRAY,
+        MAP,
+        ENUM,
+        STRING,
+        INT,
+        LONG,
+        FLOAT,
+        DOUBLE,
+        BOOLEAN,
+        NULL_,
+        // Custom wrapping another Custom, its child is the inner one
+        CUSTOM
+    };
+
+    // value size isn't known without reading it
+    static const int32_t VARIABLE = -1;
+
+    struct Item {
+        Type type;
+        // fields of a record, branches of a union, items of an array or map
+        uint32_t firstChild = 0;
+        uint32_t childCount = 0;
+        int32_t fixedSize = VARIABLE;
+        // node of the type: predicates and dumpers take it
+        const Node *node;
+        // Custom the node was defined by, nullptr if none
+        const Custom *custom = nullptr;
+    };
+
+    explicit FlatSchema(const Node &root);
+
+    const Item &operator[](uint32_t index) const {
+        return items[index];
+    }
+
+    uint32_t size() const {
+        return items.size();
+    }
+
+    uint32_t child(const Item &item, uint32_t n) const {
+        return children[item.firstChild + n];
+    }
+
+    // index of the item made of a node of the tree, 0 is the root
+    uint32_t indexOf(const Node *node) const;
+
+private:
+    std::vector<Item> items;
+    std::vector<uint32_t> children;
+    std::unordered_map<const Node *, uint32_t> byNode;
+
+    uint32_t add(const Node *node);
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef __avroq__parseprogram__
+#define __avroq__parseprogram__
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+#include "dumper/tsvexpression.h"
+#include "predicate/list.h"
+
+namespace avro {
+
+/*
+ * Parse loop compiled into one array: every instruction is an opcode
+ * followed by its operands. Jump targets are offsets in the array.
+ * Predicates and TSV fields of a node are kept aside, instructions refer
+ * to them by number.
+ */
+struct ParseProgram {
+    enum Op : uint32_t {
+        END,
+
+        // count
+        SKIP_VARINTS,
+        SKIP_STRING,
+        // bytes
+        SKIP_BYTES,
+        // schema item of a value without predicates, like arrays or maps
+        SKIP_VALUE,
+        // target
+        JUMP,
+        // branches count, target of every branch
+        UNION,
+
+        // predicates, null branch, branches count, target of every branch
+        UNION_APPLY,
+        // predicates
+        APPLY_INT,
+        APPLY_FLOAT,
+        APPLY_DOUBLE,
+        APPLY_BOOLEAN,
+        APPLY_STRING,
+        RECORD_END,
+        // predicates, schema item of elements
+        APPLY_ARRAY,
+
+        // fields
+        TSV_INT,
+        TSV_FLOAT,
+        TSV_DOUBLE,
+        TSV_BOOLEAN,
+        TSV_STRING,
+        TSV_NULL,
+        // fields, schema item
+        TSV_ENUM,
+        TSV_JSON
+    };
+
+    using predicates_t = std::pair<predicate::List::filter_items_t::iterator,
+                                   predicate::List::filter_items_t::iterator>;
+    using fields_t = dumper::TsvExpression::columns_t;
+
+    std::vector<uint32_t> code;
+    std::vector<predicates_t> predicates;
+    std::vector<fields_t> fields;
+
+    bool empty() const {
+        return code.empty();
+    }
+
+    // offset of the instruction
+    size_t emit(std::initializer_list<uint32_t> words) {
+        const size_t at = code.size();
+        code.insert(code.end(), words);
+        return at;
+    }
+
+    // Skips are added to the previous instruction when it is the same skip
+    // and nothing jumps in between, so a run of fixed size fields is one
+    // pointer bump and a run of varints is one instruction
+    void skipBytes(uint32_t bytes) {
+        if (bytes > 0) {
+            fuse(SKIP_BYTES, bytes);
+        }
+    }
+
+    void skipVarints(uint32_t count) {
+        fuse(SKIP_VARINTS, count);
+    }
+
+    // offset of the next instruction taken as a jump target, skips before
+    // and after it are kept apart
+    uint32_t label() {
+        lastSkip = NO_SKIP;
+        return code.size();
+    }
+
+    uint32_t addPredicates(const predicates_t &range) {
+        predicates.push_back(range);
+        return predicates.size() - 1;
+    }
+
+    uint32_t addFields(const fields_t &range) {
+        fields.push_back(range);
+        return fields.size() - 1;
+    }
+
+private:
+    static const size_t NO_SKIP = size_t(-1);
+    size_t lastSkip = NO_SKIP;
+
+    void fuse(Op op, uint32_t operand) {
+        if (lastSkip != NO_SKIP && lastSkip + 2 == code.size() && code[lastSkip] == op) {
+            code[lastSkip + 1] += operand;
+        } else {
+            lastSkip = emit({op, operand});
+        }
+    }
+};
+
+}
+
+#endif
@@ -7,6 +7,10 @@
 #include <filter/filter.h>
 #include <filter/record_expression.h>
 
+#include <avro/sidecar/bloom.h>
+#include <avro/sidecar/stats.h>
+
+#include "planner.h"
 #include "predicate.h"
 #include "list.h"
 
@@ -128,6 +132,25 @@ void List::resetState() {
     filter->resetState();
 }
 
+bool List::blockMayMatch(const sidecar::Stats &stats, size_t block) const {
+    auto blockStats = stats.block(block);
+    if (!blockStats) {
+        return true;
+    }
+    return predicate::blockMayMatch(filter->getAst(), stats, *blockStats);
+}
+
+bool List::blockMayMatch(const sidecar::Bloom &bloom, size_t block) const {
+    auto blockBloom = bloom.block(block);
+    if (!blockBloom) {
+        return true;
+    }
+    return predicate::blockMayMatch(filter->getAst(), bloom, *blockBloom);
+}
+
+std::vector<std::string> List::requiredLiterals() const {
+    return predicate::requiredLiterals(filter->getAst());
+}
 
 void List::assignItems() {
 
@@ -17,6 +17,10 @@ namespace avro {
 namespace node {
     class Node;
 }
+namespace sidecar {
+    class Stats;
+    class Bloom;
+}
 
 namespace predicate {
 
@@ -34,6 +38,13 @@ public:
     bool expressionPassed();
     void resetState();
 
+    // false if the block can be skipped without decoding
+    bool blockMayMatch(const sidecar::Stats &stats, size_t block) const;
+    bool blockMayMatch(const sidecar::Bloom &bloom, size_t block) const;
+
+    // strings every passing record contains, see predicate::requiredLiterals
+    std::vector<std::string> requiredLiterals() const;
+
 private:
     std::unique_ptr<filter::Filter> filter;
     filter_items_t filterItems;
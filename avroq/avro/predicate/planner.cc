@@ -0,0 +1,309 @@
+#include <climits>
+
+#include <filter/detail/ast.hpp>
+#include <filter/equality_expression.h>
+#include <filter/record_expression.h>
+
+#include <avro/sidecar/bloom.h>
+#include <avro/sidecar/stats.h>
+
+#include "planner.h"
+
+namespace avro {
+namespace predicate {
+
+namespace {
+
+// What an expression could evaluate to for records of a block
+struct Outcome {
+    bool canBeTrue;
+    bool canBeFalse;
+};
+
+const Outcome UNKNOWN = {true, true};
+
+// Compares min and max of a block with a filter constant: -1, 0, 1
+struct Bounds {
+    bool known = false;
+    int min = 0;
+    int max = 0;
+};
+
+template <typename T>
+int compare(const T &a, const T &b) {
+    return a < b ? -1 : (b < a ? 1 : 0);
+}
+
+struct CompareBounds {
+    using result_type = Bounds;
+
+    explicit CompareBounds(const sidecar::FieldStats &field) : field(field) {
+    }
+
+    Bounds operator()(int i) const {
+        // long values are compared with filter as ints
+        if (field.kind != sidecar::FieldStats::INTEGER ||
+                field.minInt < INT_MIN || field.maxInt > INT_MAX) {
+            return Bounds();
+        }
+        return integer(i);
+    }
+
+    Bounds operator()(bool b) const {
+        if (field.kind != sidecar::FieldStats::INTEGER) {
+            return Bounds();
+        }
+        return integer(b ? 1 : 0);
+    }
+
+    Bounds operator()(double d) const {
+        return real(d);
+    }
+
+    Bounds operator()(float f) const {
+        return real(f);
+    }
+
+    Bounds operator()(const std::string &s) const {
+        if (field.kind != sidecar::FieldStats::STRING) {
+            return Bounds();
+        }
+        Bounds result;
+        result.known = true;
+        result.min = compare(field.minString, s);
+        result.max = compare(field.maxString, s);
+        return result;
+    }
+
+    Bounds operator()(const filter::nil &) const {
+        return Bounds();
+    }
+
+private:
+    const sidecar::FieldStats &field;
+
+    Bounds integer(int64_t value) const {
+        Bounds result;
+        result.known = true;
+        result.min = compare(field.minInt, value);
+        result.max = compare(field.maxInt, value);
+        return result;
+    }
+
+    Bounds real(double value) const {
+        if (field.kind != sidecar::FieldStats::REAL) {
+            return Bounds();
+        }
+        Bounds result;
+        result.known = true;
+        result.min = compare(field.minReal, value);
+        result.max = compare(field.maxReal, value);
+        return result;
+    }
+};
+
+struct Planner {
+    using result_type = Outcome;
+
+    Planner(const sidecar::Stats &stats, const sidecar::BlockStats &block)
+        : stats(stats), block(block) {
+    }
+
+    Outcome operator()(const filter::nil &) const { return UNKNOWN; }
+    Outcome operator()(int) const { return UNKNOWN; }
+    Outcome operator()(const std::string &) const { return UNKNOWN; }
+
+    // predicates inside of records depend on array elements, not on fields
+    Outcome operator()(const filter::record_expression &) const { return UNKNOWN; }
+
+    Outcome operator()(const filter::equality_expression &e) const {
+        using filter::equality_expression;
+
+        if (e.is_array_element || e.parent) {
+            return UNKNOWN;
+        }
+        int i = stats.fieldIndex(e.identifier);
+        if (i < 0) {
+            return UNKNOWN;
+        }
+
+        auto const &field = block.fields[i];
+        const int64_t rows = block.objectCount;
+        if (field.nulls + field.values != rows) {
+            // not one value per record
+            return UNKNOWN;
+        }
+
+        if (e.op == equality_expression::IS_NIL) {
+            return {field.nulls > 0, field.nulls < rows};
+        }
+        if (e.op == equality_expression::NOT_NIL) {
+            return {field.values > 0, field.values < rows};
+        }
+        if (field.values == 0) {
+            // predicates are false for null values
+            return {false, rows > 0};
+        }
+        if (e.op == equality_expression::STRING || !field.bounded) {
+            return UNKNOWN;
+        }
+
+        Bounds b = boost::apply_visitor(CompareBounds(field), e.constant);
+        if (!b.known) {
+            return UNKNOWN;
+        }
+
+        const bool someNull = field.values < rows;
+        const bool constant = b.min == 0 && b.max == 0;
+        const bool inRange = b.min <= 0 && b.max >= 0;
+
+        switch (e.op) {
+            case equality_expression::EQ:
+                return {inRange, someNull || !constant};
+            case equality_expression::NE:
+                return {!constant, someNull || inRange};
+            case equality_expression::LT:
+                return {b.min < 0, someNull || b.max >= 0};
+            case equality_expression::GT:
+                return {b.max > 0, someNull || b.min <= 0};
+            case equality_expression::LE:
+                return {b.min <= 0, someNull || b.max > 0};
+            case equality_expression::GE:
+                return {b.max >= 0, someNull || b.min < 0};
+            default:
+                return UNKNOWN;
+        }
+    }
+
+    Outcome operator()(const filter::detail::expression_ast &ast) const {
+        return boost::apply_visitor(*this, ast.expr);
+    }
+
+    Outcome operator()(const filter::detail::binary_op &expr) const {
+        Outcome left = boost::apply_visitor(*this, expr.left.expr);
+        Outcome right = boost::apply_visitor(*this, expr.right.expr);
+        if (expr.op == filter::detail::binary_op::AND) {
+            return {left.canBeTrue && right.canBeTrue, left.canBeFalse || right.canBeFalse};
+        }
+        return {left.canBeTrue || right.canBeTrue, left.canBeFalse && right.canBeFalse};
+    }
+
+    Outcome operator()(const filter::detail::not_op &expr) const {
+        Outcome inner = boost::apply_visitor(*this, expr.expr.expr);
+        return {inner.canBeFalse, inner.canBeTrue};
+    }
+
+private:
+    const sidecar::Stats &stats;
+    const sidecar::BlockStats &block;
+};
+
+struct BloomProbe {
+    using result_type = bool;
+
+    BloomProbe(const sidecar::Bloom &bloom, const sidecar::BlockBloom &block)
+        : bloom(bloom), block(block) {
+    }
+
+    template <typename T>
+    bool operator()(const T &) const {
+        return true;
+    }
+
+    bool operator()(const filter::equality_expression &e) const {
+        if (e.op != filter::equality_expression::EQ || e.is_array_element || e.parent) {
+            return true;
+        }
+        int i = bloom.fieldIndex(e.identifier);
+        if (i < 0) {
+            return true;
+        }
+        auto const &field = block.fields[i];
+        if (auto value = boost::get<int>(&e.constant)) {
+            return field.mayContain(sidecar::BloomFilter::hash(*value));
+        }
+        if (auto value = boost::get<std::string>(&e.constant)) {
+            return field.mayContain(sidecar::BloomFilter::hash(value->data(), value->size()));
+        }
+        return true;
+    }
+
+    bool operator()(const filter::detail::expression_ast &ast) const {
+        return boost::apply_visitor(*this, ast.expr);
+    }
+
+    // only ANDed equalities are required to hold
+    bool operator()(const filter::detail::binary_op &expr) const {
+        return expr.op != filter::detail::binary_op::AND ||
+               (boost::apply_visitor(*this, expr.left.expr) &&
+                boost::apply_visitor(*this, expr.right.expr));
+    }
+
+private:
+    const sidecar::Bloom &bloom;
+    const sidecar::BlockBloom &block;
+};
+
+struct LiteralCollector {
+    using result_type = void;
+
+    explicit LiteralCollector(std::vector<std::string> &literals)
+        : literals(literals) {
+    }
+
+    template <typename T>
+    void operator()(const T &) const {
+    }
+
+    void operator()(const filter::equality_expression &e) const {
+        using filter::equality_expression;
+
+        // elements of an empty array pass [all] without any value
+        if ((e.op != equality_expression::EQ && e.op != equality_expression::STRING) ||
+                e.is_array_element || e.parent) {
+            return;
+        }
+        auto value = boost::get<std::string>(&e.constant);
+        if (value && !value->empty()) {
+            literals.push_back(*value);
+        }
+    }
+
+    void operator()(const filter::detail::expression_ast &ast) const {
+        boost::apply_visitor(*this, ast.expr);
+    }
+
+    void operator()(const filter::detail::binary_op &expr) const {
+        if (expr.op == filter::detail::binary_op::AND) {
+            boost::apply_visitor(*this, expr.left.expr);
+            boost::apply_visitor(*this, expr.right.expr);
+        }
+    }
+
+private:
+    std::vector<std::string> &literals;
+};
+
+}
+
+std::vector<std::string> requiredLiterals(const filter::detail::expression_ast &ast) {
+    std::vector<std::string> literals;
+    LiteralCollector collector(literals);
+    collector(ast);
+    return literals;
+}
+
+bool blockMayMatch(const filter::detail::expression_ast &ast,
+                   const sidecar::Bloom &bloom,
+                   const sidecar::BlockBloom &block) {
+    return BloomProbe(bloom, block)(ast);
+}
+
+bool blockMayMatch(const filter::detail::expression_ast &ast,
+                   const sidecar::Stats &stats,
+                   const sidecar::BlockStats &block) {
+    return Planner(stats, block)(ast).canBeTrue;
+}
+
+}
+}
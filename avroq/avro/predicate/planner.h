@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace filter {
+namespace detail {
+    struct expression_ast;
+}
+}
+
+namespace avro {
+
+namespace sidecar {
+    class Stats;
+    struct BlockStats;
+    class Bloom;
+    struct BlockBloom;
+}
+
+namespace predicate {
+
+// false if no record of the block can pass the filter judging by
+// the block's zone map. Constants of the filter have to be converted
+// to types of the schema already
+bool blockMayMatch(const filter::detail::expression_ast &ast,
+                   const sidecar::Stats &stats,
+                   const sidecar::BlockStats &block);
+
+// false if a value looked up by an equality ANDed at the top of the filter
+// is absent from the block's Bloom filter
+bool blockMayMatch(const filter::detail::expression_ast &ast,
+                   const sidecar::Bloom &bloom,
+                   const sidecar::BlockBloom &block);
+
+// string constants compared by equality or string functions ANDed at the top
+// of the filter: bytes of a matching record contain every one of them
+std::vector<std::string> requiredLiterals(const filter::detail::expression_ast &ast);
+
+}
+}
@@ -8,12 +8,17 @@
 #include "node/all_nodes.h"
 #include "node/nodebypath.h"
 
+#include "input/create.h"
+#include "input/tail.h"
+
 #include "exception.h"
 #include "filehandler.h"
 #include "schemareader.h"
 #include "stringbuffer.h"
 #include "zigzag.hpp"
 
+#include <util/memsearch.h>
+
 #include "reader.h"
 
 namespace {
@@ -28,16 +33,22 @@ public:
 
     FileHandle file;
 
-    std::unique_ptr<StringBuffer> input;
+    std::unique_ptr<input::Input> input;
+    // set if the file is followed
+    input::Tail *tail = nullptr;
 
-    Private(const std::string& filename)
+    // offset of the first block, known after the header is read
+    size_t dataStart = 0;
+
+    Private(const std::string& filename, const input::Options &options)
         : file(filename),
-          input(file.mmapFile()) {
+          input(input::createForFile(file, options)),
+          tail(dynamic_cast<input::Tail*>(input.get())) {
     }
 };
 
-Reader::Reader(const std::string& filename) :
-    d(new Private(filename)) {
+Reader::Reader(const std::string& filename, const input::Options &options) :
+    d(new Private(filename, options)) {
 }
 
 Reader::~Reader() {
@@ -75,6 +86,9 @@ header Reader::readHeader() {
     assert(c == 0); // Avro Map is over, no more elements
     d->input->read(&header.sync[0], sizeof header.sync);
 
+    if (auto whole = d->input->whole()) {
+        d->dataStart = whole->size() - whole->bytesLeft();
+    }
 
     return header;
 
@@ -87,18 +101,22 @@ void Reader::parseSchema(header &header) {
     // dumpSchema(header.schema);
 }
 
-avro::StringBuffer Reader::nextBlock(const header &header, int64_t &objectCountInBlock ) {
+std::shared_ptr<avro::StringBuffer> Reader::nextBlock(const header &header, int64_t &objectCountInBlock ) {
 
     objectCountInBlock = readZigZagLong(*d->input);
     int64_t blockBytesNum = readZigZagLong(*d->input);
 
-    if (blockBytesNum + SYNC_LENGTH > d->input->bytesLeft()) {
-        throw std::runtime_error("Corrupted file (" + d->file.fileName() + "): next block supposed to have " +
-            boost::lexical_cast<std::string>(blockBytesNum) + " bytes, but left: " +
-            boost::lexical_cast<std::string>(d->input->bytesLeft()));
+    if (blockBytesNum < 0) {
+        throw std::runtime_error("Corrupted file (" + d->file.fileName() + "): negative block size " +
+            boost::lexical_cast<std::string>(blockBytesNum));
     }
 
-    avro::StringBuffer result(d->input->getAndSkip(blockBytesNum), blockBytesNum);
+    auto result = d->input->getBlock(blockBytesNum);
+
+    if (!result) {
+        throw std::runtime_error("Corrupted file (" + d->file.fileName() + "): next block supposed to have " +
+            boost::lexical_cast<std::string>(blockBytesNum) + " bytes, but file is truncated");
+    }
 
     char tmp_sync[SYNC_LENGTH] = {0};
     d->input->read(&tmp_sync[0], sizeof tmp_sync); // TODO: move to a function
@@ -111,8 +129,128 @@ avro::StringBuffer Reader::nextBlock(const header &header, int64_t &objectCountI
 
 }
 
+std::shared_ptr<avro::StringBuffer> Reader::blockAt(size_t offset, size_t size) {
+    auto result = d->input->getBlockAt(offset, size);
+    if (!result) {
+        throw std::runtime_error("Corrupted file (" + d->file.fileName() + "): block at offset " +
+            boost::lexical_cast<std::string>(offset) + " is out of file");
+    }
+    return result;
+}
+
+size_t Reader::position() const {
+    return d->input->position();
+}
+
+size_t Reader::fileSize() const {
+    return d->file.isRegularFile() ? d->file.size() : 0;
+}
+
+std::vector<Reader::range_t> Reader::splitData(size_t parts, size_t minRangeSize) {
+
+    std::vector<range_t> result;
+
+    auto whole = d->input->whole();
+    if (!whole || parts == 0) {
+        return result;
+    }
+
+    const size_t dataSize = whole->size() - d->dataStart;
+    parts = std::max<size_t>(1, std::min(parts, dataSize / std::max<size_t>(minRangeSize, 1)));
+
+    const size_t step = dataSize / parts;
+    for(size_t i = 0; i < parts; ++i) {
+        result.emplace_back(
+            d->dataStart + i * step,
+            i + 1 == parts ? whole->size() : d->dataStart + (i + 1) * step
+        );
+    }
+    return result;
+}
+
+namespace {
+    // varint reading which never goes further than `end'
+    bool readBoundedZigZag(const char *&p, const char *end, int64_t &value) {
+        uint64_t encoded = 0;
+        for(int shift = 0; shift < 64 && p < end; shift += 7) {
+            uint8_t u = static_cast<uint8_t>(*p++);
+            encoded |= static_cast<uint64_t>(u & 0x7f) << shift;
+            if (!(u & 0x80)) {
+                value = decodeZigzag64(encoded);
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+void Reader::scanBlocks(const header &header, const range_t &range, const block_callback_t &onBlock) {
+
+    auto whole = d->input->whole();
+    assert(whole && "Reader::scanBlocks: input is not mapped");
+
+    const char *data = whole->data();
+    const char *end = data + whole->size();
+
+    // block position is either known from the previous block or guessed by the sync marker
+    bool chained = range.first == d->dataStart;
+    const char *blockStart = data + range.first - (chained ? 0 : SYNC_LENGTH);
+
+    while (true) {
+        if (!chained) {
+            // a block starts right after a sync marker
+            const char *sync = util::memsearch(blockStart, end - blockStart, header.sync, SYNC_LENGTH);
+            blockStart = sync ? sync + SYNC_LENGTH : end;
+        }
+
+        if (blockStart >= data + range.second) {
+            return;
+        }
+
+        const char *p = blockStart;
+        int64_t objectCount = 0;
+        int64_t blockBytesNum = 0;
+
+        bool valid = readBoundedZigZag(p, end, objectCount) &&
+            readBoundedZigZag(p, end, blockBytesNum) &&
+            objectCount >= 0 && blockBytesNum >= 0 &&
+            size_t(blockBytesNum) + SYNC_LENGTH <= size_t(end - p) &&
+            std::memcmp(p + blockBytesNum, header.sync, SYNC_LENGTH) == 0;
+
+        if (valid) {
+            if (!onBlock(std::make_shared<StringBuffer>(p, blockBytesNum), objectCount)) {
+                return;
+            }
+            blockStart = p + blockBytesNum + SYNC_LENGTH;
+            chained = true;
+        } else if (chained) {
+            throw std::runtime_error("Corrupted file (" + d->file.fileName() + "): bad block at offset " +
+                boost::lexical_cast<std::string>(blockStart - data));
+        } else {
+            // marker's bytes occurred inside of block data, look for the next one
+            blockStart = blockStart - SYNC_LENGTH + 1;
+        }
+    }
+}
+
 bool Reader::eof() {
-    return d->input->eof();
+    if (!d->tail) {
+        return d->input->eof();
+    }
+
+    // a block could be written partially yet
+    const char *p = d->tail->unread();
+    const char *end = p + d->tail->unreadSize();
+    int64_t objectCount = 0;
+    int64_t blockBytesNum = 0;
+    bool complete = readBoundedZigZag(p, end, objectCount) &&
+        readBoundedZigZag(p, end, blockBytesNum) &&
+        (blockBytesNum < 0 || size_t(blockBytesNum) + SYNC_LENGTH <= size_t(end - p));
+    return !complete;
+}
+
+bool Reader::waitForData(int timeoutMs) {
+    return d->tail && d->tail->waitForGrowth(timeoutMs);
 }
 
 
@@ -195,6 +333,7 @@ dumper::TsvExpression Reader::compileFieldsList(const std::string &filedList, co
         }
         result.pos++;
     }
+    result.index(header.nodesNumber);
 
     return result;
 
@@ -3,11 +3,15 @@
 
 #include <string>
 #include <cstdint>
+#include <functional>
 #include <map>
+#include <memory>
+#include <vector>
 
 #include "header.h"
 #include "stringbuffer.h"
 #include "dumper/tsvexpression.h"
+#include "input/options.h"
 
 namespace avro {
 namespace node {
@@ -19,7 +23,7 @@ struct Block;
 class Reader {
 public:
 
-    Reader(const std::string & filename);
+    Reader(const std::string & filename, const input::Options &options = input::Options());
     ~Reader();
 
     header readHeader();
@@ -27,11 +31,39 @@ public:
     void parseSchema(header &header);
 
     void nextBlock(const header &header, avro::Block &block);
-    avro::StringBuffer nextBlock(const header &header, int64_t &objectCountInBlock );
+    // Returned buffer keeps block data alive, reader itself should outlive it
+    std::shared_ptr<avro::StringBuffer> nextBlock(const header &header, int64_t &objectCountInBlock );
+
+    // Block data of known position, e.g. from an index
+    std::shared_ptr<avro::StringBuffer> blockAt(size_t offset, size_t size);
+
+    // Offset of the next block
+    size_t position() const;
+    // 0 for pipes
+    size_t fileSize() const;
+
+    using range_t = std::pair<size_t, size_t>;
+    using block_callback_t = std::function<bool(std::shared_ptr<avro::StringBuffer> block, int64_t objectCount)>;
+
+    // Cuts data after the header into at most `parts' byte ranges, not
+    // smaller than `minRangeSize' each. Empty result if input can't be
+    // accessed randomly (pipes)
+    std::vector<range_t> splitData(size_t parts, size_t minRangeSize);
+
+    // Finds blocks which start inside of `range' looking for the sync marker,
+    // so ranges could be scanned by different threads. Doesn't move
+    // reading position. Stops when callback returns false
+    void scanBlocks(const header &header, const range_t &range, const block_callback_t &onBlock);
 
     dumper::TsvExpression compileFieldsList(const std::string &filedList, const header &header, const std::string &fieldSeparator);
 
+    // With input::Options::follow true while there is no complete block
+    // to read yet
     bool eof();
+
+    // Waits up to `timeoutMs' for a followed file to grow,
+    // false if it didn't grow or the file is not followed
+    bool waitForData(int timeoutMs);
 private:
 
     class Private;
@@ -0,0 +1,171 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "sidecar.h"
+#include "bloom.h"
+
+namespace avro {
+namespace sidecar {
+
+namespace {
+    const std::string MAGIC = "AQB\001";
+
+    // about 1% of false positives
+    const int64_t BITS_PER_KEY = 10;
+    const int HASHES = 7;
+
+    const int64_t MAX_FIELDS = 4096;
+    const int64_t MAX_WORDS = 64 * 1024 * 1024;
+
+    // separates hashes of ints and of strings
+    const uint64_t INT_SEED = 0x9e3779b97f4a7c15ULL;
+    const uint64_t STRING_SEED = 0xcbf29ce484222325ULL;
+
+    uint64_t mix(uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+}
+
+BloomFilter::BloomFilter(int64_t keys)
+    : words(std::max<int64_t>(1, (keys * BITS_PER_KEY + 63) / 64)) {
+}
+
+uint64_t BloomFilter::hash(int value) {
+    return mix(INT_SEED ^ uint32_t(value));
+}
+
+uint64_t BloomFilter::hash(const char *data, size_t len) {
+    uint64_t h = STRING_SEED;
+    for(size_t i = 0; i < len; ++i) {
+        h ^= uint8_t(data[i]);
+        h *= 0x100000001b3ULL;
+    }
+    return mix(h ^ len);
+}
+
+void BloomFilter::add(uint64_t hash) {
+    const uint64_t bits = words.size() * 64;
+    const uint64_t delta = (hash >> 32) | 1;
+    for(int i = 0; i < HASHES; ++i, hash += delta) {
+        uint64_t bit = hash % bits;
+        words[bit / 64] |= uint64_t(1) << (bit % 64);
+    }
+}
+
+bool BloomFilter::mayContain(uint64_t hash) const {
+    if (words.empty()) {
+        return true;
+    }
+    const uint64_t bits = words.size() * 64;
+    const uint64_t delta = (hash >> 32) | 1;
+    for(int i = 0; i < HASHES; ++i, hash += delta) {
+        uint64_t bit = hash % bits;
+        if (!(words[bit / 64] & (uint64_t(1) << (bit % 64)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const std::string Bloom::SUFFIX = ".aqbloom";
+
+Bloom::Bloom(const std::vector<std::string> &fields)
+    : fieldList(fields) {
+}
+
+const std::vector<std::string> &Bloom::fields() const {
+    return fieldList;
+}
+
+int Bloom::fieldIndex(const std::string &path) const {
+    for(size_t i = 0; i < fieldList.size(); ++i) {
+        if (fieldList[i] == path) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void Bloom::setBlock(size_t n, BlockBloom &&block) {
+    std::lock_guard<std::mutex> lock(m);
+    if (n >= blocks.size()) {
+        blocks.resize(n + 1);
+        known.resize(n + 1);
+    }
+    blocks[n] = std::move(block);
+    known[n] = true;
+}
+
+const BlockBloom *Bloom::block(size_t n) const {
+    return n < blocks.size() && known[n] ? &blocks[n] : nullptr;
+}
+
+void Bloom::save(const std::string &avroFile, const header::sync_t &sync, size_t fileSize) const {
+    Writer writer(MAGIC, sync, fileSize);
+
+    writer.putLong(fieldList.size());
+    for(auto const &field : fieldList) {
+        writer.putString(field);
+    }
+
+    writer.putLong(blocks.size());
+    for(size_t n = 0; n < blocks.size(); ++n) {
+        writer.putLong(known[n] ? 1 : 0);
+        if (!known[n]) {
+            continue;
+        }
+        for(auto const &field : blocks[n].fields) {
+            writer.putLong(field.words.size());
+            writer.putBytes(field.words.data(), field.words.size() * sizeof(uint64_t));
+        }
+    }
+
+    writer.save(pathFor(avroFile, SUFFIX));
+}
+
+std::unique_ptr<Bloom> Bloom::load(const std::string &avroFile, const header::sync_t &sync, size_t fileSize) {
+    Loader loader(pathFor(avroFile, SUFFIX), MAGIC, sync, fileSize);
+    if (!loader.valid()) {
+        return std::unique_ptr<Bloom>();
+    }
+
+    int64_t fieldsNumber = loader.getLong();
+    if (fieldsNumber < 0 || fieldsNumber > MAX_FIELDS) {
+        throw std::runtime_error("Corrupted bloom filters of " + avroFile);
+    }
+    std::vector<std::string> fields(fieldsNumber);
+    for(auto &field : fields) {
+        field = loader.getString();
+    }
+
+    std::unique_ptr<Bloom> bloom(new Bloom(fields));
+
+    int64_t blocks = loader.getLong();
+    for(int64_t n = 0; n < blocks; ++n) {
+        if (loader.getLong() == 0) {
+            continue;
+        }
+        BlockBloom block;
+        block.fields.resize(fields.size());
+        for(auto &field : block.fields) {
+            int64_t words = loader.getLong();
+            if (words < 0 || words > MAX_WORDS) {
+                throw std::runtime_error("Corrupted bloom filters of " + avroFile);
+            }
+            field.words.resize(words);
+            memcpy(field.words.data(), loader.getBytes(words * sizeof(uint64_t)), words * sizeof(uint64_t));
+        }
+        bloom->setBlock(n, std::move(block));
+    }
+
+    return bloom;
+}
+
+}
+}
@@ -0,0 +1,74 @@
+#ifndef __avro_sidecar_bloom_h_
+#define __avro_sidecar_bloom_h_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <avro/header.h>
+
+namespace avro {
+
+class StringBuffer;
+
+namespace sidecar {
+
+// Bloom filter of values of one field in one block
+class BloomFilter {
+public:
+    BloomFilter() = default;
+    // sized for `keys' values
+    explicit BloomFilter(int64_t keys);
+
+    // int, long and enum values are hashed as the filter compares them: as int
+    static uint64_t hash(int value);
+    static uint64_t hash(const char *data, size_t len);
+
+    void add(uint64_t hash);
+    // false if the value is definitely absent
+    bool mayContain(uint64_t hash) const;
+
+    std::vector<uint64_t> words;
+};
+
+struct BlockBloom {
+    std::vector<BloomFilter> fields;
+};
+
+/*
+ * Bloom filters of chosen fields for every block, so lookups of a single
+ * key skip blocks without reading them. Blocks are filled concurrently
+ * while filters are built.
+ */
+class Bloom {
+public:
+    static const std::string SUFFIX;
+
+    explicit Bloom(const std::vector<std::string> &fields);
+
+    const std::vector<std::string> &fields() const;
+    // -1 if there is no filter for the field
+    int fieldIndex(const std::string &path) const;
+
+    void setBlock(size_t n, BlockBloom &&block);
+    // nullptr if the block is not known
+    const BlockBloom *block(size_t n) const;
+
+    void save(const std::string &avroFile, const header::sync_t &sync, size_t fileSize) const;
+
+    // nullptr if the file has no filters or they are stale
+    static std::unique_ptr<Bloom> load(const std::string &avroFile, const header::sync_t &sync, size_t fileSize);
+
+private:
+    std::vector<std::string> fieldList;
+    std::vector<BlockBloom> blocks;
+    std::vector<bool> known;
+    std::mutex m;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,88 @@
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include "sidecar.h"
+#include "index.h"
+
+namespace avro {
+namespace sidecar {
+
+namespace {
+    const std::string MAGIC = "AQI\001";
+}
+
+const std::string Index::SUFFIX = ".aqidx";
+
+void Index::add(size_t offset, size_t size, int64_t objectCount) {
+    int64_t firstRecord = list.empty() ? 0 : list.back().firstRecord + list.back().objectCount;
+    list.push_back(BlockInfo{offset, size, objectCount, firstRecord});
+}
+
+const std::vector<BlockInfo> &Index::blocks() const {
+    return list;
+}
+
+size_t Index::findRecord(int64_t record) const {
+    auto p = std::upper_bound(list.begin(), list.end(), record,
+        [](int64_t record, const BlockInfo &block) {
+            return record < block.firstRecord + block.objectCount;
+        });
+    return p - list.begin();
+}
+
+void Index::save(const std::string &avroFile, const header::sync_t &sync, size_t fileSize) const {
+    Writer writer(MAGIC, sync, fileSize);
+
+    writer.putLong(list.size());
+    for(auto const &block : list) {
+        writer.putLong(block.offset);
+        writer.putLong(block.size);
+        writer.putLong(block.objectCount);
+        writer.putLong(block.firstRecord);
+    }
+
+    writer.save(pathFor(avroFile, SUFFIX));
+}
+
+std::unique_ptr<Index> Index::load(const std::string &avroFile, const header::sync_t &sync, size_t fileSize) {
+    Loader loader(pathFor(avroFile, SUFFIX), MAGIC, sync, fileSize);
+    if (!loader.valid()) {
+        return std::unique_ptr<Index>();
+    }
+
+    std::unique_ptr<Index> index(new Index);
+
+    int64_t blocks = loader.getLong();
+    if (blocks < 0) {
+        throw std::runtime_error("Corrupted index of " + avroFile);
+    }
+    for(int64_t i = 0; i < blocks; ++i) {
+        int64_t offset = loader.getLong();
+        int64_t size = loader.getLong();
+        // checked apart, so that a huge offset or size can't wrap their sum
+        if (offset < 0 || size < 0 || size_t(offset) > fileSize || size_t(size) > fileSize - size_t(offset)) {
+            throw std::runtime_error("Corrupted index of " + avroFile);
+        }
+
+        BlockInfo block;
+        block.offset = offset;
+        block.size = size;
+        block.objectCount = loader.getLong();
+        block.firstRecord = loader.getLong();
+
+        // records are looked up by a binary search over firstRecord
+        const int64_t expectedFirst = index->list.empty() ? 0 :
+            index->list.back().firstRecord + index->list.back().objectCount;
+        if (block.objectCount < 0 || block.firstRecord != expectedFirst ||
+                block.objectCount > std::numeric_limits<int64_t>::max() - block.firstRecord) {
+            throw std::runtime_error("Corrupted index of " + avroFile);
+        }
+        index->list.push_back(block);
+    }
+
+    return index;
+}
+
+}
+}
@@ -0,0 +1,48 @@
+#ifndef __avro_sidecar_index_h_
+#define __avro_sidecar_index_h_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <avro/header.h>
+
+namespace avro {
+namespace sidecar {
+
+struct BlockInfo {
+    size_t offset;        // of the compressed data, block framing is before it
+    size_t size;          // of the compressed data
+    int64_t objectCount;
+    int64_t firstRecord;  // number of the first record of the block in the file
+};
+
+/*
+ * List of blocks of an avro file, lets read blocks without parsing
+ * the file from its beginning
+ */
+class Index {
+public:
+    static const std::string SUFFIX;
+
+    void add(size_t offset, size_t size, int64_t objectCount);
+
+    const std::vector<BlockInfo> &blocks() const;
+
+    // Number of the block containing record `record', blocks().size() if there are fewer records
+    size_t findRecord(int64_t record) const;
+
+    void save(const std::string &avroFile, const header::sync_t &sync, size_t fileSize) const;
+
+    // nullptr if the file has no index or the index is stale
+    static std::unique_ptr<Index> load(const std::string &avroFile, const header::sync_t &sync, size_t fileSize);
+
+private:
+    std::vector<BlockInfo> list;
+};
+
+}
+}
+
+#endif
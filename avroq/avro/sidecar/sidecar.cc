@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <avro/zigzag.hpp>
+
+#include "sidecar.h"
+
+namespace avro {
+namespace sidecar {
+
+std::string pathFor(const std::string &avroFile, const std::string &suffix) {
+    return avroFile + suffix;
+}
+
+Writer::Writer(const std::string &magic, const header::sync_t &sync, size_t fileSize) :
+    data(magic) {
+    putBytes(sync, sizeof sync);
+    putLong(fileSize);
+}
+
+void Writer::putLong(int64_t value) {
+    writeZigZagLong(data, value);
+}
+
+void Writer::putBytes(const void *bytes, size_t len) {
+    data.append(static_cast<const char *>(bytes), len);
+}
+
+void Writer::putString(const std::string &s) {
+    putLong(s.size());
+    putBytes(s.data(), s.size());
+}
+
+void Writer::save(const std::string &path) const {
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        out.write(data.data(), data.size());
+        out.close();
+        if (!out) {
+            throw std::runtime_error("Can't write '" + tmp + "': " + strerror(errno));
+        }
+    }
+    if (rename(tmp.c_str(), path.c_str()) != 0) {
+        throw std::runtime_error("Can't rename '" + tmp + "' to '" + path + "': " + strerror(errno));
+    }
+}
+
+Loader::Loader(const std::string &path, const std::string &magic, const header::sync_t &sync, size_t fileSize) :
+    path(path) {
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return;
+    }
+    std::ostringstream content;
+    content << in.rdbuf();
+    data = content.str();
+
+    if (data.compare(0, magic.size(), magic) != 0 || data.size() < magic.size() + sizeof sync) {
+        return;
+    }
+    pointer = magic.size();
+    if (memcmp(getBytes(sizeof sync), sync, sizeof sync) != 0) {
+        return;
+    }
+    try {
+        matched = getLong() == int64_t(fileSize);
+    } catch (const std::runtime_error &) {
+        matched = false;
+    }
+}
+
+bool Loader::valid() const {
+    return matched;
+}
+
+void Loader::truncated() const {
+    throw std::runtime_error("Truncated sidecar file '" + path + "'");
+}
+
+int64_t Loader::getLong() {
+    uint64_t encoded = 0;
+    for(int shift = 0; shift < 64; shift += 7) {
+        if (pointer >= data.size()) {
+            truncated();
+        }
+        uint8_t u = static_cast<uint8_t>(data[pointer++]);
+        encoded |= static_cast<uint64_t>(u & 0x7f) << shift;
+        if (!(u & 0x80)) {
+            return decodeZigzag64(encoded);
+        }
+    }
+    truncated();
+    return 0;
+}
+
+const char *Loader::getBytes(size_t len) {
+    if (len > data.size() - pointer) {
+        truncated();
+    }
+    const char *result = data.data() + pointer;
+    pointer += len;
+    return result;
+}
+
+std::string Loader::getString() {
+    int64_t len = getLong();
+    if (len < 0) {
+        truncated();
+    }
+    return std::string(getBytes(len), len);
+}
+
+bool Loader::eof() const {
+    return pointer >= data.size();
+}
+
+}
+}
@@ -0,0 +1,62 @@
+#ifndef __avro_sidecar_sidecar_h_
+#define __avro_sidecar_sidecar_h_
+
+#include <cstdint>
+#include <string>
+
+#include <avro/header.h>
+
+namespace avro {
+namespace sidecar {
+
+/*
+ * Sidecar files are stored next to avro files as <file><suffix>. They start
+ * with a magic, the sync marker and the size of the avro file, so
+ * a sidecar of another or appended file is not used.
+ * Numbers are avro zigzag varints.
+ */
+
+std::string pathFor(const std::string &avroFile, const std::string &suffix);
+
+class Writer {
+public:
+    Writer(const std::string &magic, const header::sync_t &sync, size_t fileSize);
+
+    void putLong(int64_t value);
+    void putBytes(const void *data, size_t len);
+    void putString(const std::string &s);
+
+    // Written via a temporary file, so readers never see a half of it
+    void save(const std::string &path) const;
+
+private:
+    std::string data;
+};
+
+class Loader {
+public:
+    Loader(const std::string &path, const std::string &magic, const header::sync_t &sync, size_t fileSize);
+
+    // false if there is no sidecar or it doesn't match the file
+    bool valid() const;
+
+    // throw std::runtime_error on truncated sidecar
+    int64_t getLong();
+    const char *getBytes(size_t len);
+    std::string getString();
+
+    bool eof() const;
+
+private:
+    std::string path;
+    std::string data;
+    size_t pointer = 0;
+    bool matched = false;
+
+    void truncated() const;
+};
+
+}
+}
+
+#endif
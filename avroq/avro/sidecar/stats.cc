@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include <avro/stringbuffer.h>
+
+#include "sidecar.h"
+#include "stats.h"
+
+namespace avro {
+namespace sidecar {
+
+namespace {
+    const std::string MAGIC = "AQS\001";
+
+    // longer strings make stats bigger than the data
+    const size_t MAX_STRING = 256;
+
+    const int64_t MAX_FIELDS = 4096;
+
+    void putReal(Writer &writer, double value) {
+        writer.putBytes(&value, sizeof value);
+    }
+
+    double getReal(Loader &loader) {
+        double value;
+        memcpy(&value, loader.getBytes(sizeof value), sizeof value);
+        return value;
+    }
+}
+
+void FieldStats::add(int64_t value) {
+    kind = INTEGER;
+    if (values == 0) {
+        minInt = maxInt = value;
+    } else {
+        minInt = std::min(minInt, value);
+        maxInt = std::max(maxInt, value);
+    }
+    ++values;
+}
+
+void FieldStats::add(double value) {
+    kind = REAL;
+    if (std::isnan(value)) {
+        bounded = false;
+    } else if (values == 0) {
+        minReal = maxReal = value;
+    } else {
+        minReal = std::min(minReal, value);
+        maxReal = std::max(maxReal, value);
+    }
+    ++values;
+}
+
+void FieldStats::add(const StringBuffer &value) {
+    kind = STRING;
+    if (value.size() > MAX_STRING) {
+        bounded = false;
+    }
+    if (bounded) {
+        std::string s(value.data(), value.size());
+        if (values == 0) {
+            minString = maxString = s;
+        } else if (s < minString) {
+            minString = s;
+        } else if (s > maxString) {
+            maxString = s;
+        }
+    }
+    ++values;
+}
+
+void FieldStats::addNull() {
+    ++nulls;
+}
+
+const std::string Stats::SUFFIX = ".aqstats";
+
+Stats::Stats(const std::vector<std::string> &fields)
+    : fieldList(fields) {
+}
+
+const std::vector<std::string> &Stats::fields() const {
+    return fieldList;
+}
+
+int Stats::fieldIndex(const std::string &path) const {
+    for(size_t i = 0; i < fieldList.size(); ++i) {
+        if (fieldList[i] == path) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void Stats::setBlock(size_t n, BlockStats &&block) {
+    std::lock_guard<std::mutex> lock(m);
+    if (n >= blocks.size()) {
+        blocks.resize(n + 1);
+        known.resize(n + 1);
+    }
+    blocks[n] = std::move(block);
+    known[n] = true;
+}
+
+const BlockStats *Stats::block(size_t n) const {
+    return n < blocks.size() && known[n] ? &blocks[n] : nullptr;
+}
+
+void Stats::save(const std::string &avroFile, const header::sync_t &sync, size_t fileSize) const {
+    Writer writer(MAGIC, sync, fileSize);
+
+    writer.putLong(fieldList.size());
+    for(auto const &field : fieldList) {
+        writer.putString(field);
+    }
+
+    writer.putLong(blocks.size());
+    for(size_t n = 0; n < blocks.size(); ++n) {
+        writer.putLong(known[n] ? blocks[n].objectCount : -1);
+        if (!known[n]) {
+            continue;
+        }
+        for(auto const &field : blocks[n].fields) {
+            auto kind = field.bounded ? field.kind : FieldStats::NONE;
+            writer.putLong(kind);
+            writer.putLong(field.nulls);
+            writer.putLong(field.values);
+            if (kind == FieldStats::INTEGER) {
+                writer.putLong(field.minInt);
+                writer.putLong(field.maxInt);
+            } else if (kind == FieldStats::REAL) {
+                putReal(writer, field.minReal);
+                putReal(writer, field.maxReal);
+            } else if (kind == FieldStats::STRING) {
+                writer.putString(field.minString);
+                writer.putString(field.maxString);
+            }
+        }
+    }
+
+    writer.save(pathFor(avroFile, SUFFIX));
+}
+
+std::unique_ptr<Stats> Stats::load(const std::string &avroFile, const header::sync_t &sync, size_t fileSize) {
+    Loader loader(pathFor(avroFile, SUFFIX), MAGIC, sync, fileSize);
+    if (!loader.valid()) {
+        return std::unique_ptr<Stats>();
+    }
+
+    int64_t fieldsNumber = loader.getLong();
+    if (fieldsNumber < 0 || fieldsNumber > MAX_FIELDS) {
+        throw std::runtime_error("Corrupted stats of " + avroFile);
+    }
+    std::vector<std::string> fields(fieldsNumber);
+    for(auto &field : fields) {
+        field = loader.getString();
+    }
+
+    std::unique_ptr<Stats> stats(new Stats(fields));
+
+    int64_t blocks = loader.getLong();
+    for(int64_t n = 0; n < blocks; ++n) {
+        BlockStats block;
+        block.objectCount = loader.getLong();
+        if (block.objectCount < 0) {
+            continue;
+        }
+        block.fields.resize(fields.size());
+        for(auto &field : block.fields) {
+            field.kind = static_cast<FieldStats::Kind>(loader.getLong());
+            field.nulls = loader.getLong();
+            field.values = loader.getLong();
+            if (field.kind == FieldStats::INTEGER) {
+                field.minInt = loader.getLong();
+                field.maxInt = loader.getLong();
+            } else if (field.kind == FieldStats::REAL) {
+                field.minReal = getReal(loader);
+                field.maxReal = getReal(loader);
+            } else if (field.kind == FieldStats::STRING) {
+                field.minString = loader.getString();
+                field.maxString = loader.getString();
+            } else if (field.kind != FieldStats::NONE) {
+                throw std::runtime_error("Corrupted stats of " + avroFile);
+            }
+        }
+        stats->setBlock(n, std::move(block));
+    }
+
+    return stats;
+}
+
+}
+}
@@ -0,0 +1,85 @@
+#ifndef __avro_sidecar_stats_h_
+#define __avro_sidecar_stats_h_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <avro/header.h>
+
+namespace avro {
+
+class StringBuffer;
+
+namespace sidecar {
+
+// Range of values of one field in one block. Integers, booleans and enum
+// indexes are INTEGER, float and double are REAL
+struct FieldStats {
+    enum Kind : int {
+        NONE,
+        INTEGER,
+        REAL,
+        STRING
+    };
+
+    Kind kind = NONE;
+    bool bounded = true; // false if the range can't be trusted (NaN, huge strings)
+    int64_t nulls = 0;
+    int64_t values = 0;
+
+    int64_t minInt = 0;
+    int64_t maxInt = 0;
+    double minReal = 0;
+    double maxReal = 0;
+    std::string minString;
+    std::string maxString;
+
+    void add(int64_t value);
+    void add(double value);
+    void add(const StringBuffer &value);
+    void addNull();
+};
+
+struct BlockStats {
+    int64_t objectCount = 0;
+    std::vector<FieldStats> fields;
+};
+
+/*
+ * Zone map of an avro file: ranges and null counts of chosen fields for
+ * every block, so blocks which can't match a filter are skipped unread.
+ * Blocks are filled concurrently while stats are built.
+ */
+class Stats {
+public:
+    static const std::string SUFFIX;
+
+    explicit Stats(const std::vector<std::string> &fields);
+
+    const std::vector<std::string> &fields() const;
+    // -1 if there are no stats for the field
+    int fieldIndex(const std::string &path) const;
+
+    void setBlock(size_t n, BlockStats &&block);
+    // nullptr if the block is not known
+    const BlockStats *block(size_t n) const;
+
+    void save(const std::string &avroFile, const header::sync_t &sync, size_t fileSize) const;
+
+    // nullptr if the file has no stats or they are stale
+    static std::unique_ptr<Stats> load(const std::string &avroFile, const header::sync_t &sync, size_t fileSize);
+
+private:
+    std::vector<std::string> fieldList;
+    std::vector<BlockStats> blocks;
+    std::vector<bool> known;
+    std::mutex m;
+};
+
+}
+}
+
+#endif
@@ -1,6 +1,11 @@
 #ifndef __avroq__avro_typeparser__
 #define __avroq__avro_typeparser__
 
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
 #include "zigzag.hpp"
 #include "stringbuffer.h"
 
@@ -136,6 +141,63 @@ public:
 };
 
 
+/*
+ * Arrays and maps are series of blocks ended by an empty one. A block
+ * starts with its items count; a negative count is followed by the size
+ * of the block in bytes, so the block could be skipped at once.
+ */
+[[noreturn]] inline
+void corruptedItems(const std::string &what) {
+    throw std::runtime_error("Corrupted file: " + what + " of array or map block");
+}
+
+// byte size of a block with a negative count
+template <class Stream>
+int64_t readItemsSize(Stream &stream) {
+    const int64_t size = readZigZagLong(stream);
+    if (size < 0) {
+        corruptedItems("negative size " + std::to_string(size));
+    }
+    return size;
+}
+
+inline
+int64_t itemsOfNegativeCount(int64_t count) {
+    if (count == std::numeric_limits<int64_t>::min()) {
+        corruptedItems("items count " + std::to_string(count));
+    }
+    return -count;
+}
+
+template <class Stream>
+int64_t readItemsCount(Stream &stream) {
+    int64_t count = readZigZagLong(stream);
+    if (count < 0) {
+        readItemsSize(stream);
+        count = itemsOfNegativeCount(count);
+    }
+    return count;
+}
+
+// Jumps over blocks which have their size. Returns items count of the next
+// block, which has to be walked item by item; 0 at the end of the series.
+// A size going past the end of data stops at eof(), as other values do:
+// a record cut by a streamed window is read again once the window grows
+template <class Stream>
+int64_t skipSizedItems(Stream &stream) {
+    while (true) {
+        int64_t count = readZigZagLong(stream);
+        if (count >= 0) {
+            return count;
+        }
+        itemsOfNegativeCount(count);
+        stream.skip(readItemsSize(stream));
+        if (stream.eof()) {
+            return 0;
+        }
+    }
+}
+
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,103 @@
+#ifndef __avroq__varint__
+#define __avroq__varint__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace avro {
+namespace varint {
+
+/*
+ * Varints read from wide loads. Callers make sure the loaded bytes are
+ * memory of the buffer: 8 bytes from `p' for decode(), 16 bytes from every
+ * position below `end' for skip().
+ */
+
+// Value of a varint of up to 8 bytes, false for a longer one
+inline
+bool decode(const uint8_t *p, uint64_t &value, size_t &length) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint64_t x;
+    std::memcpy(&x, p, sizeof(x));
+
+    const uint64_t stops = ~x & 0x8080808080808080ULL;
+    if (!stops) {
+        return false;
+    }
+    const int last = __builtin_ctzll(stops);
+    length = last / 8 + 1;
+    if (last < 63) {
+        x &= (uint64_t(1) << (last + 1)) - 1;
+    }
+    // 7 bit groups are moved together by pairs, quads and halves
+    x &= 0x7f7f7f7f7f7f7f7fULL;
+    x = (x & 0x007f007f007f007fULL) | ((x & 0x7f007f007f007f00ULL) >> 1);
+    x = (x & 0x00003fff00003fffULL) | ((x & 0x3fff00003fff0000ULL) >> 2);
+    x = (x & 0x000000000fffffffULL) | ((x & 0x0fffffff00000000ULL) >> 4);
+    value = x;
+    return true;
+#else
+    return false;
+#endif
+}
+
+/*
+ * Skips `count' varints while 16 bytes can be loaded, a byte without the
+ * high bit ends a varint, so they are counted in the mask of high bits.
+ * Returns the position reached, `count' is left with varints not skipped.
+ */
+inline
+const uint8_t *skip(const uint8_t *p, const uint8_t *end, uint32_t &count) {
+#ifdef __SSE2__
+    // continuation bytes of the varint cut by the previous load
+    uint32_t run = 0;
+
+    while (count > 0 && p + 16 <= end) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        uint32_t continued = _mm_movemask_epi8(block);
+        const uint32_t stops = ~continued & 0xffff;
+
+        uint32_t found = __builtin_popcount(stops);
+        uint32_t used = 16;
+        if (found >= count) {
+            uint32_t s = stops;
+            for(uint32_t k = 1; k < count; ++k) {
+                s &= s - 1;
+            }
+            used = __builtin_ctz(s) + 1;
+            continued &= (1u << used) - 1;
+            found = count;
+        }
+
+        // a varint of 10 bytes with the high bit set is invalid
+        const uint32_t firstStop = stops ? __builtin_ctz(stops) : 16;
+        const uint32_t run2 = continued & (continued >> 1);
+        const uint32_t run4 = run2 & (run2 >> 2);
+        const uint32_t run8 = run4 & (run4 >> 4);
+        if (run + firstStop >= 10 || (run8 & (run2 >> 8))) {
+            throw std::runtime_error("Invalid Avro varint");
+        }
+        p += used;
+        count -= found;
+        if (count > 0) {
+            run = stops ? __builtin_clz(stops) - 16 : run + 16;
+        }
+    }
+    // the rest is read from the start of the cut varint
+    if (count > 0) {
+        p -= run;
+    }
+#endif
+    return p;
+}
+
+}
+}
+
+#endif
@@ -1,6 +1,10 @@
 #ifndef avroq_zigzag_hpp
 #define avroq_zigzag_hpp
 
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
 #include "eof.h"
 
 namespace avro {
@@ -11,6 +15,22 @@ int64_t decodeZigzag64(uint64_t input)
     return static_cast<int64_t>(((input >> 1) ^ -(static_cast<int64_t>(input) & 1)));
 }
 
+inline
+uint64_t encodeZigzag64(int64_t input)
+{
+    return (static_cast<uint64_t>(input) << 1) ^ static_cast<uint64_t>(input >> 63);
+}
+
+inline
+void writeZigZagLong(std::string &to, int64_t value) {
+    uint64_t encoded = encodeZigzag64(value);
+    do {
+        uint8_t u = encoded & 0x7f;
+        encoded >>= 7;
+        to.push_back(static_cast<char>(encoded ? (u | 0x80) : u));
+    } while (encoded);
+}
+
 template <class BufferType>
 inline
 long readZigZagLong(BufferType &b) {
@@ -52,6 +72,13 @@ void skipZigZagLong(BufferType &b) {
     } while (u & 0x80);
 }
 
+template <class BufferType>
+inline
+void skipZigZagLongs(BufferType &b, uint32_t count) {
+    for(; count > 0; --count) {
+        skipZigZagLong(b);
+    }
+}
 
 }
 #endif
@@ -0,0 +1,108 @@
+// Inflates deflate blocks of Avro files with every engine and prints the
+// speed of each. Usage: inflatebench [-r ROUNDS] FILE...
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <avro/codec/create.h>
+#include <avro/codec/options.h>
+#include <avro/node/node.h>
+#include <avro/reader.h>
+
+namespace {
+
+    struct Engine {
+        const char *name;
+        avro::codec::Options::InflateEngine engine;
+    };
+
+    const Engine engines[] = {
+        {"zlib", avro::codec::Options::InflateEngine::ZLIB},
+        {"fast", avro::codec::Options::InflateEngine::FAST}
+    };
+
+}
+
+int main(int argc, char **argv) {
+    int rounds = 5;
+    std::vector<std::string> files;
+    for(int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            rounds = std::atoi(argv[++i]);
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+    if (files.empty() || rounds < 1) {
+        std::cerr << "Usage: inflatebench [-r ROUNDS] FILE..." << std::endl;
+        return 1;
+    }
+
+    try {
+        // readers keep block data alive
+        std::vector<std::unique_ptr<avro::Reader>> readers;
+        std::vector<avro::header> headers;
+        std::vector<std::pair<size_t, std::shared_ptr<avro::StringBuffer>>> blocks;
+
+        for(const auto &file : files) {
+            readers.emplace_back(new avro::Reader(file));
+            auto &reader = *readers.back();
+            headers.push_back(reader.readHeader());
+            if (avro::codec::codecName(headers.back()) != "deflate") {
+                std::cerr << file << ": not deflate, skipped" << std::endl;
+                continue;
+            }
+            while (!reader.eof()) {
+                int64_t objectCount;
+                blocks.emplace_back(headers.size() - 1, reader.nextBlock(headers.back(), objectCount));
+            }
+        }
+        if (blocks.empty()) {
+            std::cerr << "No deflate blocks" << std::endl;
+            return 1;
+        }
+
+        size_t compressed = 0;
+        for(const auto &b : blocks) {
+            compressed += b.second->size();
+        }
+
+        size_t reference = 0;
+        for(const auto &e : engines) {
+            avro::codec::Options options;
+            options.inflateEngine = e.engine;
+            auto codec = avro::codec::createForHeader(headers[blocks[0].first], options);
+            avro::codec::storage_t storage;
+
+            size_t inflated = 0;
+            const auto start = std::chrono::steady_clock::now();
+            for(int r = 0; r < rounds; ++r) {
+                inflated = 0;
+                for(const auto &b : blocks) {
+                    inflated += codec->decode(*b.second, storage).size();
+                }
+            }
+            const std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+
+            if (reference && inflated != reference) {
+                std::cerr << e.name << ": inflated " << inflated << " bytes instead of " << reference << std::endl;
+                return 1;
+            }
+            reference = inflated;
+
+            std::cout << e.name << ": " << blocks.size() << " blocks, "
+                      << compressed << " -> " << inflated << " bytes, "
+                      << inflated * rounds / seconds.count() / (1 << 20) << " MB/s" << std::endl;
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
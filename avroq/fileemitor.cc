@@ -1,17 +1,30 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <exception>
 #include <functional>
 #include <iostream>
 #include <thread>
 #include <mutex>
 
+#include <boost/algorithm/string.hpp>
 #include <boost/lambda/lambda.hpp>
 
 #include <util/onscopeexit.h>
 
 #include <avro/node/all_nodes.h>
+#include <avro/node/nodebypath.h>
+#include <avro/block.h>
 #include <avro/blockdecoder.h>
 #include <avro/exception.h>
 #include <avro/header.h>
 #include <avro/reader.h>
+#include <avro/codec/create.h>
+#include <avro/input/prefetcher.h>
+#include <avro/predicate/list.h>
+#include <avro/sidecar/bloom.h>
+#include <avro/sidecar/index.h>
+#include <avro/sidecar/stats.h>
 
 #include <filter/filter.h>
 #include <filter/equality_expression.h>
@@ -20,19 +33,90 @@
 #include <util/onscopeexit.h>
 
 #include "fileemitor.h"
+#include "filelist.h"
+#include "fileopener.h"
+
+namespace {
+    // don't bother threads with ranges smaller than this
+    const size_t MIN_SCAN_RANGE = 16 * 1024 * 1024;
+
+    // how many files ahead are opened and read by the prefetcher
+    const size_t PREFETCH_FILES = 4;
+    const size_t PREFETCH_QUEUE = 64;
+
+    // opened files waiting for the emitor, per opening thread
+    const size_t OPEN_AHEAD_PER_THREAD = 4;
+
+    // how often a followed file is checked for growth and stop is checked
+    const int FOLLOW_POLL_MS = 1000;
+
+    // how often threads waiting for a stage check whether they have to move to the other one
+    const std::chrono::milliseconds STAGE_POLL(50);
+    // stage threads are balanced after that many decoded blocks
+    const size_t BALANCE_BLOCKS = 32;
+
+    // scalars and unions of a scalar with null have one value per record
+    bool isStatsScalar(const avro::node::Node *node) {
+        return node->isOneOf<
+                    avro::node::Boolean,
+                    avro::node::Double,
+                    avro::node::Enum,
+                    avro::node::Float,
+                    avro::node::Int,
+                    avro::node::Long,
+                    avro::node::String
+                >();
+    }
+
+    const avro::node::Node *notCustom(const avro::node::Node *node) {
+        return node->is<avro::node::Custom>()
+                   ? node->as<avro::node::Custom>().getDefinition().get()
+                   : node;
+    }
 
+    // Bloom filters are checked by equality only
+    bool isBloomScalar(const avro::node::Node *node) {
+        return node->isOneOf<
+                    avro::node::Enum,
+                    avro::node::Int,
+                    avro::node::Long,
+                    avro::node::String
+                >();
+    }
+
+    bool isSidecarField(const avro::node::Node *node, bool (*isScalar)(const avro::node::Node *)) {
+        node = notCustom(node);
+        if (!node->is<avro::node::Union>()) {
+            return isScalar(node);
+        }
+        auto const &children = node->as<avro::node::Union>().getChildren();
+        size_t scalars = 0;
+        for(auto const &n : children) {
+            auto child = notCustom(n.get());
+            if (isScalar(child)) {
+                ++scalars;
+            } else if (!child->is<avro::node::Null>()) {
+                return false;
+            }
+        }
+        return scalars == 1;
+    }
+}
 
 
-FileEmitor::FileEmitor( const std::vector<std::string> &fileList,
+FileEmitor::FileEmitor( FileList &files,
                         int limit,
                         std::function<void(const std::string&)> outDocument) :
-    fileList(fileList),
+    files(files),
     outDocument(outDocument),
     limiter(limit),
     countedDocuments(0) {
 
 }
 
+FileEmitor::~FileEmitor() {
+}
+
 void FileEmitor::enablePrintProcessingFile() {
     printProcessingFile = true;
 }
@@ -50,6 +134,59 @@ void FileEmitor::setTsvFieldList(const std::string &tsvFieldList, const std::str
     this->fieldSeparator = fieldSeparator;
 }
 
+void FileEmitor::setScanJobs(size_t jobs) {
+    scanJobs = jobs;
+}
+
+void FileEmitor::setMmapWindow(size_t bytes) {
+    inputOptions.mmapWindow = bytes;
+}
+
+void FileEmitor::setOpenJobs(size_t jobs) {
+    openJobs = jobs;
+}
+
+void FileEmitor::enablePrefetch(size_t blocks) {
+    inputOptions.prefetchBlocks = blocks;
+    inputOptions.prefetcher = std::make_shared<avro::input::Prefetcher>(PREFETCH_QUEUE);
+}
+
+void FileEmitor::setCodecOptions(const avro::codec::Options &options) {
+    codecOptions = options;
+}
+
+const avro::codec::Options &FileEmitor::getCodecOptions() const {
+    return codecOptions;
+}
+
+void FileEmitor::enableBuildIndex() {
+    buildIndex = true;
+}
+
+void FileEmitor::enableBuildStats(const std::string &fields) {
+    buildStats = true;
+    buildFieldList = fields;
+}
+
+void FileEmitor::enableBuildBloom(const std::string &fields) {
+    buildBloom = true;
+    buildFieldList = fields;
+}
+
+void FileEmitor::enablePrintPosition() {
+    printPosition = true;
+}
+
+void FileEmitor::enableFollow() {
+    follow = true;
+    inputOptions.follow = true;
+}
+
+void FileEmitor::seek(int64_t block, int64_t record) {
+    seekBlock = block;
+    seekRecord = record;
+}
+
 void FileEmitor::enableParseLoop() {
     parseLoopEnabled = true;
 }
@@ -59,13 +196,113 @@ void FileEmitor::outputAsJson(bool pretty) {
     jsonPrettyMode = pretty;
 }
 
+void FileEmitor::enableStages(size_t inflateJobs, size_t decodeJobs, bool balance) {
+    stages = true;
+    balanceStages = balance;
+    stageThreads = inflateJobs + decodeJobs;
+    inflateThreads = inflateJobs;
+}
+
+void FileEmitor::enableSplitBlocks(size_t records) {
+    splitRecords = records;
+}
+
+bool FileEmitor::isInflateThread(size_t thread) const {
+    return thread < inflateThreads;
+}
+
+bool FileEmitor::getNextToInflate(std::shared_ptr<Task> &task) {
+    ++inflating;
+    if (queue.pop_for(task, STAGE_POLL)) {
+        return true;
+    }
+    leaveInflateStage();
+    return false;
+}
+
+void FileEmitor::inflated(std::shared_ptr<Task> task, uint64_t nanoseconds) {
+    inflateNanoseconds += nanoseconds;
+    inflatedQueue.push(task);
+    leaveInflateStage();
+}
+
+void FileEmitor::inflateFailed(std::shared_ptr<Task> task) {
+    releaseStorage(*task);
+    leaveInflateStage();
+}
+
+void FileEmitor::leaveInflateStage() {
+    if (--inflating == 0 && queue.finished()) {
+        inflatingDone = true;
+        // the last block is inflated: balanced threads go decoding
+        if (balanceStages) {
+            inflateThreads = 0;
+        }
+        inflatedQueue.done();
+    }
+}
+
+void FileEmitor::decoded(std::shared_ptr<Task> task, uint64_t nanoseconds) {
+    decodeNanoseconds += nanoseconds;
+    releaseStorage(*task);
+    if (balanceStages && ++decodedBlocks % BALANCE_BLOCKS == 0) {
+        balance();
+    }
+}
+
+void FileEmitor::balance() {
+    const double inflateTime = inflateNanoseconds;
+    const double decodeTime = decodeNanoseconds;
+    if (inflateThreads == 0 || inflateTime + decodeTime == 0) {
+        return;
+    }
+    // threads by share of time, at least one at each stage
+    size_t threads = std::lround(stageThreads * inflateTime / (inflateTime + decodeTime));
+    threads = std::max<size_t>(1, std::min(threads, stageThreads - 1));
+
+    size_t current = inflateThreads;
+    // the inflate stage may be over meanwhile, don't bring it back
+    while (current != 0 && !inflateThreads.compare_exchange_weak(current, threads)) {
+    }
+}
+
+void FileEmitor::releaseStorage(Task &task) {
+    // parts of a split block share storage, the last one returns it
+    if (task.storage && task.storage.use_count() == 1) {
+        std::lock_guard<std::mutex> lock(storageLock);
+        storagePool.push_back(std::move(task.storage));
+    }
+}
+
+std::shared_ptr<avro::codec::storage_t> FileEmitor::getStorage() {
+    std::lock_guard<std::mutex> lock(storageLock);
+    if (storagePool.empty()) {
+        return std::make_shared<avro::codec::storage_t>();
+    }
+    auto storage = std::move(storagePool.back());
+    storagePool.pop_back();
+    return storage;
+}
+
+bool FileEmitor::isInflatingDone() const {
+    return inflatingDone;
+}
+
+bool FileEmitor::isDecodingDone() {
+    return inflatedQueue.finished();
+}
+
 std::shared_ptr<Task> FileEmitor::getNextTask(
     std::unique_ptr<avro::BlockDecoder> &decoder,
     size_t &fileId) {
 
     std::shared_ptr<Task> task;
 
-    if (!queue.pop(task)) {
+    if (stages) {
+        if (!inflatedQueue.pop_for(task, STAGE_POLL)) {
+            return std::shared_ptr<Task>();
+        }
+    } else if (!queue.pop(task)) {
     	return std::shared_ptr<Task>();
     }
     if (!decoder || fileId != task->fileId) {
@@ -84,7 +321,10 @@ std::shared_ptr<Task> FileEmitor::getNextTask(
         if (jsonMode) {
             decoder->outputAsJson(jsonPrettyMode);
         }
-        if (filter) {
+        if (printPosition) {
+            decoder->enablePrintPosition();
+        }
+        if (filter && !task->statsBuild && !task->bloomBuild) {
             try {
                 decoder->setFilter(
                         std::unique_ptr<filter::Filter>(
@@ -134,12 +374,32 @@ std::shared_ptr<Task> FileEmitor::returnStop(const std::string &reason) {
     lastError = reason;
     stop = true;
     queue.done();
+    queue.clear(); // queued tasks may hold buffers the emitor waits for
+    inflatedQueue.done();
+    inflatedQueue.clear();
     return std::shared_ptr<Task>();
 }
 
 void FileEmitor::finished() {
     stop = true;
     queue.done();
+    queue.clear();
+    inflatedQueue.done();
+    inflatedQueue.clear();
+}
+
+void FileEmitor::saveSidecars() {
+    if (stop) {
+        return;
+    }
+    for(auto const &s : sidecarsToSave) {
+        if (s.stats) {
+            s.stats->save(s.fileName, s.header->sync, s.fileSize);
+        }
+        if (s.bloom) {
+            s.bloom->save(s.fileName, s.header->sync, s.fileSize);
+        }
+    }
 }
 
 const std::string &FileEmitor::getLastError() const {
@@ -162,43 +422,72 @@ void FileEmitor::mainLoop() {
 			queue.done();
 		});
 
+	std::unique_ptr<FileOpener> opener;
+	if (openJobs > 1) {
+	    opener.reset(new FileOpener(files, openJobs, openJobs * OPEN_AHEAD_PER_THREAD,
+	        [this](const std::string &fileName, OpenedFile &file) {
+	            openFile(fileName, file);
+	        }));
+	}
+
+	util::on_scope_exit stopWalking([this]() {
+			files.cancel();
+		});
+
 	size_t currentFileId = 0;
-	for(auto const &currentFileName : fileList) {
+	std::string currentFileName;
+	for(currentFile = 0; files.get(currentFile, currentFileName); ++currentFile) {
+
+        if (inputOptions.prefetcher) {
+            std::string nextFileName;
+            for(; prefetchedFile <= currentFile + PREFETCH_FILES && files.tryGet(prefetchedFile, nextFileName); ++prefetchedFile) {
+                if (prefetchedFile > currentFile) {
+                    inputOptions.prefetcher->file(nextFileName);
+                }
+            }
+        }
 
         if (printProcessingFile) {
             std::cerr << "Processing " << currentFileName << std::endl;
         }
 
-        try {
-            currentTaskSample.reader.reset(new avro::Reader(currentFileName));
-        } catch (const std::runtime_error &e) {
-            std::cerr << e.what() << std::endl;
-            stop = true;
-            return;
+        std::unique_ptr<OpenedFile> file;
+        if (opener) {
+            file = opener->get(currentFile);
+        } else {
+            file.reset(new OpenedFile);
+            openFile(currentFileName, *file);
+        }
+
+        if (file->openError) {
+            try {
+                std::rethrow_exception(file->openError);
+            } catch (const std::runtime_error &e) {
+                std::cerr << e.what() << std::endl;
+                stop = true;
+                return;
+            }
         }
-        auto newHeader = currentTaskSample.reader->readHeader();
-        if (currentTaskSample.header && newHeader == *currentTaskSample.header) {
-            currentTaskSample.header->setSync(newHeader.sync);
+        if (file->headerError) {
+            std::rethrow_exception(file->headerError);
+        }
+
+        currentTaskSample.reader = file->reader;
+        bool schemaChanged = false;
+        if (currentTaskSample.header && *file->header == *currentTaskSample.header) {
+            currentTaskSample.header->setSync(file->header->sync);
         } else {
+            schemaChanged = true;
 
             ++currentFileId;
 
-            currentTaskSample.reader->parseSchema(newHeader);
-
-            currentTaskSample.header.reset(
-                    new avro::header(std::move(newHeader))
-                );
+            currentTaskSample.header = file->header;
 
             try {
-                currentTaskSample.tsvFieldsList.reset(
-                        new avro::dumper::TsvExpression(
-                            currentTaskSample.reader->compileFieldsList(
-                                    tsvFieldList,
-                                    *currentTaskSample.header,
-                                    fieldSeparator
-                                )
-                        )
-                    );
+                if (file->tsvError) {
+                    std::rethrow_exception(file->tsvError);
+                }
+                currentTaskSample.tsvFieldsList = file->tsvFieldsList;
             } catch (const avro::PathNotFound &e) {
                 stop = true;
                 lastError = "Can't apply TSV expression to file: " + currentFileName + "\n"
@@ -214,22 +503,365 @@ void FileEmitor::mainLoop() {
         }
 		currentTaskSample.currentFileName = currentFileName;
 
-		while(!currentTaskSample.reader->eof()) {
+		if (buildIndex) {
+		    buildFileIndex(currentFileName, *file);
+		    continue;
+		}
 
-		    std::shared_ptr<Task> task(new Task(currentTaskSample));
+		if (buildStats || buildBloom) {
+		    if (!buildFileSidecar(currentFileName, *file, currentFileId)) {
+		        return;
+		    }
+		    continue;
+		}
+
+		preparePlanner(*file, schemaChanged);
+
+		if (file->index && !follow) {
+		    if (!emitIndexedBlocks(*file->index, currentFileId)) {
+		        return;
+		    }
+		    continue;
+		}
+
+		// parallel scanning loses block numbers, and takes blocks right from
+		// the mapping, past windows and prefetching of the input
+		if (scanJobs > 1 && !printPosition && !follow && !currentStats && !currentBloom && seekBlock < 0 && seekRecord == 0 &&
+		        inputOptions.mmapWindow == 0 && !inputOptions.prefetcher) {
+		    auto ranges = currentTaskSample.reader->splitData(scanJobs, MIN_SCAN_RANGE);
+		    if (ranges.size() > 1) {
+		        if (!scanInParallel(ranges, currentFileId)) {
+		            return;
+		        }
+		        continue;
+		    }
+		}
 
-		    task->fileId = currentFileId;
+		size_t blockNumber = 0;
+		int64_t firstRecord = 0;
+		do {
+		    while(!currentTaskSample.reader->eof()) {
 
-		    task->buffer.reset(new avro::StringBuffer(
-		        task->reader->nextBlock(
+		        std::shared_ptr<Task> task(new Task(currentTaskSample));
+
+		        task->fileId = currentFileId;
+		        task->blockNumber = blockNumber++;
+
+		        task->buffer = task->reader->nextBlock(
 		            *task->header,
 		            task->objectCount
-		        )
-		    ));
-			if (!queue.push(task)) {
-				return;
-			}
-		}
+		        );
+
+		        bool needed = seekTo(task->blockNumber, firstRecord, task->objectCount, task->skipObjects) &&
+		                      blockMayMatch(task->blockNumber);
+		        firstRecord += task->objectCount;
+		        if (!needed) {
+		            continue;
+		        }
+		        if (!pushTask(task)) {
+		            return;
+		        }
+		    }
+		} while (waitForData(currentFile));
 
 	}
 }
+
+bool FileEmitor::waitForData(size_t fileNumber) {
+    if (!follow) {
+        return false;
+    }
+    // only the last file is followed, writers append to the newest one
+    std::string nextFileName;
+    if (files.get(fileNumber + 1, nextFileName)) {
+        return false;
+    }
+    while (!stop) {
+        if (currentTaskSample.reader->waitForData(FOLLOW_POLL_MS)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FileEmitor::seekTo(size_t blockNumber, int64_t firstRecord, int64_t objectCount, int64_t &skip) const {
+    if (seekBlock >= 0) {
+        if (int64_t(blockNumber) < seekBlock) {
+            return false;
+        }
+        skip = int64_t(blockNumber) == seekBlock ? seekRecord : 0;
+    } else {
+        if (firstRecord + objectCount <= seekRecord) {
+            return false;
+        }
+        skip = std::max<int64_t>(0, seekRecord - firstRecord);
+    }
+    return true;
+}
+
+bool FileEmitor::pushTask(std::shared_ptr<Task> task) {
+    // counting without a filter doesn't look at records
+    if (splitRecords == 0 || task->objectCount <= int64_t(splitRecords) || (countMode && !filter)) {
+        return queue.push(task);
+    }
+    return pushSplitBlock(task);
+}
+
+bool FileEmitor::pushSplitBlock(std::shared_ptr<Task> task) {
+    const auto &header = *task->header;
+    if (!splitCodec || avro::codec::codecName(header) != splitCodecName) {
+        splitCodec = avro::codec::createForHeader(header, codecOptions);
+        splitCodecName = avro::codec::codecName(header);
+    }
+    if (!splitScanner || splitScannerFile != task->fileId) {
+        splitScanner.reset(new avro::BlockDecoder(header, limiter));
+        splitScannerFile = task->fileId;
+    }
+
+    auto storage = getStorage();
+    auto data = splitCodec->decode(*task->buffer, *storage);
+
+    avro::Block block;
+    block.buffer.assignData(data);
+    block.objectCount = task->objectCount;
+    block.number = task->blockNumber;
+    auto offsets = splitScanner->findRecords(block, splitRecords);
+
+    for(size_t k = 0; k + 1 < offsets.size(); ++k) {
+        const int64_t firstRecord = int64_t(k * splitRecords);
+        const int64_t objectCount = std::min<int64_t>(splitRecords, task->objectCount - firstRecord);
+        if (firstRecord + objectCount <= task->skipObjects) {
+            continue;
+        }
+
+        std::shared_ptr<Task> part(new Task(*task));
+        part->storage = storage;
+        part->inflated = std::make_shared<avro::StringBuffer>(
+                data.data() + offsets[k], offsets[k + 1] - offsets[k]
+            );
+        part->firstRecord = firstRecord;
+        part->objectCount = objectCount;
+        part->skipObjects = std::max<int64_t>(0, task->skipObjects - firstRecord);
+        if (!queue.push(part)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FileEmitor::emitIndexedBlocks(const avro::sidecar::Index &index, size_t fileId) {
+    auto const &blocks = index.blocks();
+
+    size_t first = seekBlock >= 0 ? size_t(seekBlock) : index.findRecord(seekRecord);
+
+    for(size_t n = first; n < blocks.size(); ++n) {
+        std::shared_ptr<Task> task(new Task(currentTaskSample));
+
+        task->fileId = fileId;
+        task->blockNumber = n;
+        task->objectCount = blocks[n].objectCount;
+
+        if (!seekTo(n, blocks[n].firstRecord, blocks[n].objectCount, task->skipObjects) ||
+                !blockMayMatch(n)) {
+            continue;
+        }
+
+        task->buffer = task->reader->blockAt(blocks[n].offset, blocks[n].size);
+
+        if (!pushTask(task)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void FileEmitor::buildFileIndex(const std::string &fileName, OpenedFile &file) {
+    if (file.reader->fileSize() == 0) {
+        throw std::runtime_error("Can't build index of " + fileName + ": not a regular file");
+    }
+
+    avro::sidecar::Index index;
+    while (!file.reader->eof()) {
+        int64_t objectCount = 0;
+        auto block = file.reader->nextBlock(*file.header, objectCount);
+        // reader stands after the sync marker of the block
+        size_t offset = file.reader->position() - sizeof file.header->sync - block->size();
+        index.add(offset, block->size(), objectCount);
+    }
+
+    index.save(fileName, file.header->sync, file.reader->fileSize());
+}
+
+bool FileEmitor::buildFileSidecar(const std::string &fileName, OpenedFile &file, size_t fileId) {
+    const std::string what = buildStats ? "stats" : "Bloom filters";
+    if (file.reader->fileSize() == 0) {
+        throw std::runtime_error("Can't build " + what + " of " + fileName + ": not a regular file");
+    }
+
+    std::vector<std::string> fields;
+    boost::algorithm::split(fields, buildFieldList, boost::is_any_of(","));
+    for(auto &field : fields) {
+        boost::algorithm::trim(field);
+        auto node = avro::node::nodeByPath(field, file.header->schema.get());
+        if (!node || !isSidecarField(node, buildStats ? isStatsScalar : isBloomScalar)) {
+            throw std::runtime_error("Can't build " + what + " of " + fileName + ": field '" + field +
+                                     "' is not " + (buildStats ? "a scalar" : "a string, int, long or enum") +
+                                     " or a union of one with null");
+        }
+    }
+
+    std::shared_ptr<avro::sidecar::Stats> stats;
+    std::shared_ptr<avro::sidecar::Bloom> bloom;
+    if (buildStats) {
+        stats = std::make_shared<avro::sidecar::Stats>(fields);
+    } else {
+        bloom = std::make_shared<avro::sidecar::Bloom>(fields);
+    }
+    sidecarsToSave.push_back({fileName, file.header, file.reader->fileSize(), stats, bloom});
+
+    size_t blockNumber = 0;
+    while(!currentTaskSample.reader->eof()) {
+        std::shared_ptr<Task> task(new Task(currentTaskSample));
+
+        task->fileId = fileId;
+        task->blockNumber = blockNumber++;
+        task->statsBuild = stats;
+        task->bloomBuild = bloom;
+        task->buffer = task->reader->nextBlock(*task->header, task->objectCount);
+
+        if (!queue.push(task)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void FileEmitor::preparePlanner(const OpenedFile &file, bool schemaChanged) {
+    currentStats = filter ? file.stats : nullptr;
+    currentBloom = filter ? file.bloom : nullptr;
+    // constants and paths of the planner are of the schema it was made for
+    if (schemaChanged) {
+        planner.reset();
+    }
+    if (!currentStats && !currentBloom) {
+        return;
+    }
+    if (!planner) {
+        try {
+            planner.reset(new avro::predicate::List(
+                    std::unique_ptr<filter::Filter>(new filter::Filter(*filter)),
+                    currentTaskSample.header->schema.get()
+                ));
+        } catch (const std::runtime_error &e) {
+            // workers report bad filters
+            planner.reset();
+        }
+    }
+}
+
+bool FileEmitor::blockMayMatch(size_t blockNumber) const {
+    if (!planner) {
+        return true;
+    }
+    return (!currentStats || planner->blockMayMatch(*currentStats, blockNumber)) &&
+           (!currentBloom || planner->blockMayMatch(*currentBloom, blockNumber));
+}
+
+void FileEmitor::openFile(const std::string &fileName, OpenedFile &file) {
+    try {
+        file.reader.reset(new avro::Reader(fileName, inputOptions));
+    } catch (...) {
+        file.openError = std::current_exception();
+        return;
+    }
+
+    try {
+        file.header.reset(new avro::header(file.reader->readHeader()));
+        file.reader->parseSchema(*file.header);
+    } catch (...) {
+        file.headerError = std::current_exception();
+        return;
+    }
+
+    // sidecars of a growing file are stale anyway
+    if (!buildIndex && !follow && file.reader->fileSize() > 0) {
+        try {
+            file.index = avro::sidecar::Index::load(fileName, file.header->sync, file.reader->fileSize());
+        } catch (const std::runtime_error &e) {
+            std::cerr << e.what() << ", reading without index" << std::endl;
+        }
+    }
+
+    if (!buildStats && !buildBloom && !follow && filter && file.reader->fileSize() > 0) {
+        try {
+            file.stats = avro::sidecar::Stats::load(fileName, file.header->sync, file.reader->fileSize());
+        } catch (const std::runtime_error &e) {
+            std::cerr << e.what() << ", reading without stats" << std::endl;
+        }
+        try {
+            file.bloom = avro::sidecar::Bloom::load(fileName, file.header->sync, file.reader->fileSize());
+        } catch (const std::runtime_error &e) {
+            std::cerr << e.what() << ", reading without Bloom filters" << std::endl;
+        }
+    }
+
+    try {
+        file.tsvFieldsList.reset(
+                new avro::dumper::TsvExpression(
+                    file.reader->compileFieldsList(
+                            buildStats || buildBloom ? buildFieldList : tsvFieldList,
+                            *file.header,
+                            fieldSeparator
+                        )
+                )
+            );
+    } catch (...) {
+        file.tsvError = std::current_exception();
+    }
+}
+
+bool FileEmitor::scanInParallel(const std::vector<std::pair<size_t, size_t>> &ranges, size_t fileId) {
+
+    std::vector<std::thread> scanners;
+    std::vector<std::exception_ptr> errors(ranges.size());
+    std::atomic_bool accepted(true);
+    // splitting of huge blocks goes through the emitor's codec and scanner
+    std::mutex pushing;
+
+    for(size_t i = 0; i < ranges.size(); ++i) {
+        scanners.emplace_back([this, &ranges, &errors, &accepted, &pushing, i, fileId]() {
+            try {
+                currentTaskSample.reader->scanBlocks(
+                    *currentTaskSample.header,
+                    ranges[i],
+                    [this, &accepted, &pushing, fileId](std::shared_ptr<avro::StringBuffer> block, int64_t objectCount) {
+                        std::shared_ptr<Task> task(new Task(currentTaskSample));
+                        task->fileId = fileId;
+                        task->buffer = block;
+                        task->objectCount = objectCount;
+                        std::lock_guard<std::mutex> lock(pushing);
+                        if (!accepted || !pushTask(task)) {
+                            accepted = false;
+                        }
+                        return bool(accepted);
+                    }
+                );
+            } catch (...) {
+                errors[i] = std::current_exception();
+                accepted = false;
+            }
+        });
+    }
+
+    for(auto &t : scanners) {
+        t.join();
+    }
+
+    for(auto &e : errors) {
+        if (e) {
+            std::rethrow_exception(e);
+        }
+    }
+
+    return accepted;
+}
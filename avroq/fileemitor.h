@@ -1,12 +1,16 @@
 #ifndef _fileemitor_h
 #define _fileemitor_h
 
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <vector>
 
 #include <avro/limiter.h>
+#include <avro/codec/codec.h>
+#include <avro/codec/options.h>
+#include <avro/input/options.h>
 
 #include <util/concurrentqueue.hpp>
 
@@ -19,17 +23,38 @@ namespace avro {
   namespace dumper {
      struct TsvExpression;
   }
+  namespace sidecar {
+     class Index;
+     class Stats;
+     class Bloom;
+  }
+  namespace predicate {
+     class List;
+  }
 }
 
 namespace filter {
   class Filter;
 }
+struct OpenedFile;
+class FileList;
+
 struct Task {
     std::shared_ptr<avro::Reader> reader;
     std::shared_ptr<avro::header> header;
     std::shared_ptr<avro::StringBuffer> buffer;
     std::shared_ptr<avro::dumper::TsvExpression> tsvFieldsList;
     int64_t objectCount;
+    int64_t skipObjects = 0;
+    size_t blockNumber = 0;
+    // stats or Bloom filters of the block are collected here instead of dumping records
+    std::shared_ptr<avro::sidecar::Stats> statsBuild;
+    std::shared_ptr<avro::sidecar::Bloom> bloomBuild;
+    // block inflated by the inflate stage into `storage', see enableStages
+    std::shared_ptr<avro::codec::storage_t> storage;
+    std::shared_ptr<avro::StringBuffer> inflated;
+    // record of the block `inflated' starts from, see enableSplitBlocks
+    int64_t firstRecord = 0;
     size_t fileId;
     std::string currentFileName;
 };
@@ -37,7 +62,8 @@ struct Task {
 class FileEmitor {
 public:
 
-    FileEmitor(const std::vector<std::string> &fileList, int limit, std::function<void(const std::string&)> outDocument);
+    FileEmitor(FileList &files, int limit, std::function<void(const std::string&)> outDocument);
+    ~FileEmitor();
 
     std::shared_ptr<Task> getNextTask(std::unique_ptr<avro::BlockDecoder> &decoder, size_t &fileId);
 
@@ -46,7 +72,46 @@ public:
     void enableParseLoop();
     void setFilter(std::shared_ptr<filter::Filter> filter);
     void setTsvFieldList(const std::string &tsvFieldList, const std::string &fieldSeparator);
+    void setScanJobs(size_t jobs);
+    void setOpenJobs(size_t jobs);
+    void setMmapWindow(size_t bytes);
+    void enablePrefetch(size_t blocks);
+    void setCodecOptions(const avro::codec::Options &options);
+    const avro::codec::Options &getCodecOptions() const;
+    void enableBuildIndex();
+    // comma separated fields, like TSV field list
+    void enableBuildStats(const std::string &fields);
+    void enableBuildBloom(const std::string &fields);
+    void enablePrintPosition();
+    // keep reading the last file as it grows
+    void enableFollow();
+    // Blocks are inflated and decoded by different threads, Worker(emitor, n)
+    // with n from 0 to inflateJobs + decodeJobs - 1. When balanced, threads
+    // move between the stages by time the stages take
+    void enableStages(size_t inflateJobs, size_t decodeJobs, bool balance);
+    // Blocks of more than `records' records are inflated and scanned for
+    // record boundaries by the emitor, their parts are decoded in parallel
+    void enableSplitBlocks(size_t records);
+    // thread number `thread' works at the inflate stage now
+    bool isInflateThread(size_t thread) const;
+    // false when there is no block to inflate for now
+    bool getNextToInflate(std::shared_ptr<Task> &task);
+    void inflated(std::shared_ptr<Task> task, uint64_t nanoseconds);
+    // the task taken by getNextToInflate wasn't inflated, it's dropped
+    void inflateFailed(std::shared_ptr<Task> task);
+    // called for a task of the decode stage whether it was decoded or not
+    void decoded(std::shared_ptr<Task> task, uint64_t nanoseconds);
+    std::shared_ptr<avro::codec::storage_t> getStorage();
+    // all blocks went through the inflate stage
+    bool isInflatingDone() const;
+    // all blocks went through the decode stage
+    bool isDecodingDone();
+    // record number `record' of the file if `block' is negative,
+    // record in the block otherwise
+    void seek(int64_t block, int64_t record);
     void finished();
+    // writes stats and Bloom filters collected by workers, call after they are done
+    void saveSidecars();
 
     size_t getCountedDocuments() const;
 
@@ -56,10 +121,11 @@ public:
     void operator()();
 
 private:
-    const std::vector<std::string> &fileList;
+    FileList &files;
     std::string fieldSeparator;
     bool printProcessingFile = false;
     size_t currentFile = 0;
+    size_t prefetchedFile = 0;
     std::function<void(const std::string&)> outDocument;
     std::mutex ownLock;
     Task currentTaskSample;
@@ -67,17 +133,79 @@ private:
     std::shared_ptr<filter::Filter> filter;
     std::string tsvFieldList;
     std::atomic_size_t countedDocuments;
-    bool stop = false;
+    std::atomic_bool stop{false};
     bool countMode = false;
     bool parseLoopEnabled = false;
     bool jsonMode = false;
     bool jsonPrettyMode = false;
+    size_t scanJobs = 1;
+    size_t openJobs = 1;
+    bool buildIndex = false;
+    bool buildStats = false;
+    bool buildBloom = false;
+    std::string buildFieldList;
+    bool printPosition = false;
+    bool follow = false;
+    int64_t seekBlock = -1;
+    int64_t seekRecord = 0;
+    avro::input::Options inputOptions;
+    avro::codec::Options codecOptions;
     std::string lastError;
 
+    struct SidecarToSave {
+        std::string fileName;
+        std::shared_ptr<avro::header> header;
+        size_t fileSize;
+        std::shared_ptr<avro::sidecar::Stats> stats;
+        std::shared_ptr<avro::sidecar::Bloom> bloom;
+    };
+    std::vector<SidecarToSave> sidecarsToSave;
+
+    // filter bound to the schema of the current file to check zone maps
+    std::unique_ptr<avro::predicate::List> planner;
+    std::shared_ptr<const avro::sidecar::Stats> currentStats;
+    std::shared_ptr<const avro::sidecar::Bloom> currentBloom;
+
     util::conqurrent_queue<std::shared_ptr<Task>> queue;
 
+    // inflated blocks are big, few of them wait for the decode stage
+    util::conqurrent_queue<std::shared_ptr<Task>, 4> inflatedQueue;
+    bool stages = false;
+    bool balanceStages = false;
+    size_t stageThreads = 0;
+    std::atomic_size_t inflateThreads{0};
+    // threads at the inflate stage which may still push a block
+    std::atomic_size_t inflating{0};
+    std::atomic_bool inflatingDone{false};
+    std::atomic<uint64_t> inflateNanoseconds{0};
+    std::atomic<uint64_t> decodeNanoseconds{0};
+    std::atomic_size_t decodedBlocks{0};
+    std::mutex storageLock;
+    std::vector<std::shared_ptr<avro::codec::storage_t>> storagePool;
+
+    size_t splitRecords = 0;
+    std::shared_ptr<avro::codec::Codec> splitCodec;
+    std::string splitCodecName;
+    std::unique_ptr<avro::BlockDecoder> splitScanner;
+    size_t splitScannerFile = -1;
+
+    void leaveInflateStage();
+    void releaseStorage(Task &task);
+    void balance();
+
     bool canProduceNextTask();
     void mainLoop();
+    void openFile(const std::string &fileName, OpenedFile &file);
+    void buildFileIndex(const std::string &fileName, OpenedFile &file);
+    bool buildFileSidecar(const std::string &fileName, OpenedFile &file, size_t fileId);
+    void preparePlanner(const OpenedFile &file, bool schemaChanged);
+    bool blockMayMatch(size_t blockNumber) const;
+    bool waitForData(size_t fileNumber);
+    bool emitIndexedBlocks(const avro::sidecar::Index &index, size_t fileId);
+    bool seekTo(size_t blockNumber, int64_t firstRecord, int64_t objectCount, int64_t &skip) const;
+    bool pushTask(std::shared_ptr<Task> task);
+    bool pushSplitBlock(std::shared_ptr<Task> task);
+    bool scanInParallel(const std::vector<std::pair<size_t, size_t>> &ranges, size_t fileId);
 
     void countDocument(size_t num);
 
@@ -0,0 +1,190 @@
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <iostream>
+
+#include "filelist.h"
+
+FileList::FileList(const std::vector<std::string> &paths, size_t walkJobs) {
+
+    for(auto const &path : paths) {
+        root.children.emplace_back(new Directory());
+        Directory &child = *root.children.back();
+        child.path = path;
+
+        struct stat st;
+        if (path == "-" || stat(path.c_str(), &st) != 0 || !S_ISDIR(st.st_mode)) {
+            // a file is a leaf read already, errors are reported when it's opened
+            child.files.push_back(path);
+            child.read = true;
+        }
+    }
+
+    root.read = true;
+    appended.emplace_back(&root, 0);
+    // files given before the first directory are available at once
+    appendFiles();
+
+    // directories are taken from the back
+    for(auto p = root.children.rbegin(); p != root.children.rend(); ++p) {
+        if (!(*p)->read) {
+            directories.push_back(p->get());
+        }
+    }
+
+    if (!directories.empty()) {
+        for(size_t i = 0; i < std::max<size_t>(walkJobs, 1); ++i) {
+            walkers.emplace_back([this]() { walk(); });
+        }
+    }
+}
+
+FileList::~FileList() {
+    cancel();
+    for(auto &t : walkers) {
+        t.join();
+    }
+}
+
+void FileList::cancel() {
+    std::unique_lock<std::mutex> lock(m);
+    stop = true;
+    changed.notify_all();
+}
+
+bool FileList::complete() const {
+    return stop || (directories.empty() && directoriesInWork == 0);
+}
+
+bool FileList::get(size_t n, std::string &fileName) {
+    std::unique_lock<std::mutex> lock(m);
+
+    while (n >= files.size() && !complete()) {
+        changed.wait(lock);
+    }
+    if (n >= files.size()) {
+        return false;
+    }
+    fileName = files[n];
+    return true;
+}
+
+bool FileList::tryGet(size_t n, std::string &fileName) {
+    std::unique_lock<std::mutex> lock(m);
+
+    if (n >= files.size()) {
+        return false;
+    }
+    fileName = files[n];
+    return true;
+}
+
+void FileList::walk() {
+    while (true) {
+        Directory *directory;
+        {
+            std::unique_lock<std::mutex> lock(m);
+            while (directories.empty() && !complete()) {
+                changed.wait(lock);
+            }
+            if (complete()) {
+                return;
+            }
+            directory = directories.back();
+            directories.pop_back();
+            ++directoriesInWork;
+        }
+
+        readDirectory(*directory);
+
+        std::unique_lock<std::mutex> lock(m);
+        --directoriesInWork;
+        changed.notify_all();
+    }
+}
+
+void FileList::readDirectory(Directory &directory) {
+    const std::string &path = directory.path;
+
+    DIR *dir = opendir(path.c_str());
+    if (!dir) {
+        std::cerr << "Can't read directory '" << path << "': " << strerror(errno) << std::endl;
+
+        std::unique_lock<std::mutex> lock(m);
+        directory.read = true;
+        appendFiles();
+        return;
+    }
+
+    std::vector<std::string> foundFiles;
+    std::vector<std::string> foundDirectories;
+
+    while (struct dirent *entry = readdir(dir)) {
+        if (entry->d_name[0] == '.' || entry->d_name[0] == '_') {
+            continue;
+        }
+
+        std::string name = path + "/" + entry->d_name;
+        bool isDirectory = entry->d_type == DT_DIR;
+        bool isFile = entry->d_type == DT_REG;
+
+        if (entry->d_type == DT_UNKNOWN || entry->d_type == DT_LNK) {
+            // symlinks to directories are not followed to avoid loops
+            struct stat st;
+            if (fstatat(dirfd(dir), entry->d_name, &st, 0) != 0) {
+                continue;
+            }
+            isDirectory = entry->d_type == DT_UNKNOWN && S_ISDIR(st.st_mode);
+            isFile = S_ISREG(st.st_mode);
+        }
+
+        if (isDirectory) {
+            foundDirectories.push_back(std::move(name));
+        } else if (isFile) {
+            foundFiles.push_back(std::move(name));
+        }
+    }
+    closedir(dir);
+
+    std::sort(foundFiles.begin(), foundFiles.end());
+    std::sort(foundDirectories.begin(), foundDirectories.end());
+
+    std::unique_lock<std::mutex> lock(m);
+    directory.files = std::move(foundFiles);
+    for(auto &name : foundDirectories) {
+        directory.children.emplace_back(new Directory());
+        directory.children.back()->path = std::move(name);
+    }
+    directory.read = true;
+
+    // the first subdirectory is read next, as the tree is walked in order
+    for(auto p = directory.children.rbegin(); p != directory.children.rend(); ++p) {
+        directories.push_back(p->get());
+    }
+    appendFiles();
+    changed.notify_all();
+}
+
+void FileList::appendFiles() {
+    while (!appended.empty()) {
+        auto &top = appended.back();
+        if (top.second == top.first->children.size()) {
+            // whole subtree is appended
+            top.first->children.clear();
+            appended.pop_back();
+            continue;
+        }
+        Directory *next = top.first->children[top.second].get();
+        if (!next->read) {
+            return;
+        }
+        ++top.second;
+        files.insert(files.end(), next->files.begin(), next->files.end());
+        next->files.clear();
+        appended.emplace_back(next, 0);
+    }
+}
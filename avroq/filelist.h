@@ -0,0 +1,64 @@
+#ifndef _filelist_h
+#define _filelist_h
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Input files in order of processing. Paths are taken in the order they
+ * are given, directories are walked recursively by a pool of threads.
+ * Found files are appended in the order of the tree, sorted by name, as
+ * soon as the paths and directories before them are read, so processing
+ * doesn't wait for the whole tree and the order doesn't depend on the
+ * number of walkers.
+ * Hidden files and ones starting with '_' (_SUCCESS, _logs of Hadoop
+ * jobs) are skipped.
+ */
+class FileList {
+public:
+    FileList(const std::vector<std::string> &paths, size_t walkJobs);
+    ~FileList();
+
+    // Waits until file number `n' is found. false if there are fewer files
+    bool get(size_t n, std::string &fileName);
+
+    // Same, but doesn't wait for the walkers
+    bool tryGet(size_t n, std::string &fileName);
+
+    // Stops walking, files which are not found yet won't be returned
+    void cancel();
+
+private:
+    struct Directory {
+        std::string path;
+        bool read = false;
+        std::vector<std::string> files;
+        std::vector<std::unique_ptr<Directory>> children;
+    };
+
+    std::vector<std::string> files;
+    // paths given explicitly are children of the root, files are leaves
+    Directory root;
+    // directories to read
+    std::vector<Directory *> directories;
+    size_t directoriesInWork = 0;
+    // directories files of which are appended, with their next child
+    std::vector<std::pair<Directory *, size_t>> appended;
+    bool stop = false;
+
+    std::mutex m;
+    std::condition_variable changed;
+    std::vector<std::thread> walkers;
+
+    bool complete() const;
+    void walk();
+    void readDirectory(Directory &directory);
+    // appends files of read directories which follow the appended ones
+    void appendFiles();
+};
+
+#endif
@@ -0,0 +1,72 @@
+#include "filelist.h"
+#include "fileopener.h"
+
+FileOpener::FileOpener(FileList &files, size_t threads, size_t ahead, open_func_t open) :
+    files(files),
+    ahead(ahead),
+    open(open) {
+
+    for(size_t i = 0; i < threads; ++i) {
+        this->threads.emplace_back([this]() { run(); });
+    }
+}
+
+FileOpener::~FileOpener() {
+    {
+        std::unique_lock<std::mutex> lock(m);
+        stop = true;
+        changed.notify_all();
+    }
+    for(auto &t : threads) {
+        t.join();
+    }
+}
+
+std::unique_ptr<OpenedFile> FileOpener::get(size_t n) {
+    std::unique_lock<std::mutex> lock(m);
+
+    auto p = opened.find(n);
+    while (p == opened.end()) {
+        changed.wait(lock);
+        p = opened.find(n);
+    }
+
+    auto result = std::move(p->second);
+    opened.erase(p);
+
+    taken = n + 1;
+    changed.notify_all();
+
+    return result;
+}
+
+void FileOpener::run() {
+    while (true) {
+        size_t n = 0;
+        {
+            std::unique_lock<std::mutex> lock(m);
+            while (!stop && !noMoreFiles && nextToOpen >= taken + ahead) {
+                changed.wait(lock);
+            }
+            if (stop || noMoreFiles) {
+                return;
+            }
+            n = nextToOpen++;
+        }
+
+        std::string fileName;
+        if (!files.get(n, fileName)) {
+            std::unique_lock<std::mutex> lock(m);
+            noMoreFiles = true;
+            changed.notify_all();
+            return;
+        }
+
+        std::unique_ptr<OpenedFile> file(new OpenedFile);
+        open(fileName, *file);
+
+        std::unique_lock<std::mutex> lock(m);
+        opened[n] = std::move(file);
+        changed.notify_all();
+    }
+}
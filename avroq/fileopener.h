@@ -0,0 +1,76 @@
+#ifndef _fileopener_h
+#define _fileopener_h
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class FileList;
+
+namespace avro {
+  class Reader;
+  struct header;
+  namespace dumper {
+     struct TsvExpression;
+  }
+  namespace sidecar {
+     class Index;
+     class Stats;
+     class Bloom;
+  }
+}
+
+// File with the header read and the schema parsed, ready for reading blocks.
+// Errors are kept to be reported by the emitor in the order of files
+struct OpenedFile {
+    std::shared_ptr<avro::Reader> reader;
+    std::shared_ptr<avro::header> header;
+    std::shared_ptr<avro::dumper::TsvExpression> tsvFieldsList;
+    std::shared_ptr<const avro::sidecar::Index> index;
+    std::shared_ptr<const avro::sidecar::Stats> stats;
+    std::shared_ptr<const avro::sidecar::Bloom> bloom;
+    std::exception_ptr openError;
+    std::exception_ptr headerError;
+    std::exception_ptr tsvError;
+};
+
+/*
+ * Pool of threads opening files ahead of the emitor. Files are handed out
+ * strictly in order of the list, no more than `ahead' of them are kept
+ * opened and not taken.
+ */
+class FileOpener {
+public:
+    using open_func_t = std::function<void(const std::string &fileName, OpenedFile &file)>;
+
+    FileOpener(FileList &files, size_t threads, size_t ahead, open_func_t open);
+    ~FileOpener();
+
+    // waits until file number `n' is opened, the file has to exist in the list
+    std::unique_ptr<OpenedFile> get(size_t n);
+
+private:
+    FileList &files;
+    size_t ahead;
+    open_func_t open;
+
+    std::map<size_t, std::unique_ptr<OpenedFile>> opened;
+    size_t nextToOpen = 0;
+    size_t taken = 0;
+    bool noMoreFiles = false;
+    bool stop = false;
+
+    std::mutex m;
+    std::condition_variable changed;
+    std::vector<std::thread> threads;
+
+    void run();
+};
+
+#endif
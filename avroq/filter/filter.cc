@@ -138,6 +138,10 @@ Filter::Filter(const Filter& oldFilter) : ast(oldFilter.ast) {
     extractor(this->ast);
 }
 
+const detail::expression_ast &Filter::getAst() const {
+    return ast;
+}
+
 bool Filter::expressionPassed() const {
     detail::AstRunner runner;
     return runner(ast);
@@ -27,6 +27,8 @@ public:
     std::vector<record_expression*> getRecordExpressions(equality_expression*e);
     std::vector<record_expression*> getRecordExpressions(record_expression*r);
 
+    const detail::expression_ast &getAst() const;
+
     bool expressionPassed() const;
     void resetState();
 private:
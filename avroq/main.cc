@@ -1,15 +1,20 @@
 
+#include <unistd.h>
+
+#include <algorithm>
 #include <iostream>
 #include <string>
 
 #include <thread>
 #include <mutex>
 
+#include <boost/lexical_cast.hpp>
 #include <boost/program_options.hpp>
 
 #include "filter/compiler.h"
 
 #include "fileemitor.h"
+#include "filelist.h"
 #include "version.h"
 #include "worker.h"
 namespace po = boost::program_options;
@@ -60,6 +65,37 @@ void correctJobsNumber(u_int &jobs) {
     }
 }
 
+// "N" or "BLOCK:RECORD"
+bool parseSeekPosition(const std::string &position, int64_t &block, int64_t &record) {
+    try {
+        auto colon = position.find(':');
+        if (colon == std::string::npos) {
+            record = boost::lexical_cast<int64_t>(position);
+        } else {
+            block = boost::lexical_cast<int64_t>(position.substr(0, colon));
+            record = boost::lexical_cast<int64_t>(position.substr(colon + 1));
+            if (block < 0) {
+                return false;
+            }
+        }
+    } catch (const boost::bad_lexical_cast &) {
+        return false;
+    }
+    return record >= 0;
+}
+
+// "zlib" or "fast"
+bool parseInflateEngine(const std::string &name, avro::codec::Options &options) {
+    if (name == "zlib") {
+        options.inflateEngine = avro::codec::Options::InflateEngine::ZLIB;
+    } else if (name == "fast") {
+        options.inflateEngine = avro::codec::Options::InflateEngine::FAST;
+    } else {
+        return false;
+    }
+    return true;
+}
+
 int main(int argc, const char * argv[]) {
 
     std::cout.sync_with_stdio(false);
@@ -67,6 +103,23 @@ int main(int argc, const char * argv[]) {
     std::string condition;
     int limit = -1;
     u_int jobs = 1;
+    u_int inflateJobs = 0;
+    u_int decodeJobs = 0;
+    bool balanceJobs = false;
+    u_int splitBlocks = 0;
+    u_int scanJobs = 1;
+    u_int openJobs = 1;
+    u_int walkJobs = 4;
+    u_int mmapWindow = 0;
+    u_int prefetch = 0;
+    std::string inflateEngine;
+    u_int inflateWindow = 0;
+    bool buildIndex = false;
+    std::string statsFields;
+    std::string bloomFields;
+    bool printPosition = false;
+    bool follow = false;
+    std::string seekPosition;
     std::string fields;
     bool printProcessingFile = false;
     bool countMode = false;
@@ -78,12 +131,29 @@ int main(int argc, const char * argv[]) {
 
     po::options_description desc("Allowed options");
     desc.add_options()
-        ("input-file,f", po::value< std::vector<std::string> >(), "Input files")
+        ("input-file,f", po::value< std::vector<std::string> >(), "Input files or directories (\"-\" for stdin, default if stdin is not a terminal)")
         ("condition,c", po::value< std::string >(&condition), "Expression")
         ("limit,n", po::value< int >(&limit)->default_value(-1), "Maximum number of records (default -1 means no limit)")
         ("fields,l", po::value< std::string >(&fields), "Fields to output")
         ("print-file", po::bool_switch(&printProcessingFile), "Print name of processing file")
         ("jobs,j", po::value< u_int >(&jobs)->default_value(1), "Number of threads to run")
+        ("inflate-jobs", po::value< u_int >(&inflateJobs)->default_value(0), "Number of threads decompressing blocks for --decode-jobs threads (0 makes the same threads do both, see --jobs)")
+        ("decode-jobs", po::value< u_int >(&decodeJobs)->default_value(0), "Number of threads decoding blocks decompressed by --inflate-jobs threads")
+        ("balance-jobs", po::bool_switch(&balanceJobs), "Move --inflate-jobs and --decode-jobs threads between the stages by time they take")
+        ("split-blocks", po::value< u_int >(&splitBlocks)->default_value(0), "Decode blocks of more than N records by parts of N records in parallel (0 disables)")
+        ("walk-jobs", po::value< u_int >(&walkJobs)->default_value(4), "Number of threads walking input directories")
+        ("open-jobs", po::value< u_int >(&openJobs)->default_value(1), "Number of threads opening files and parsing their headers ahead")
+        ("scan-jobs", po::value< u_int >(&scanJobs)->default_value(1), "Number of threads looking for blocks inside of one big file, records of its parts come out interleaved")
+        ("mmap-window", po::value< u_int >(&mmapWindow)->default_value(0), "Drop already processed parts of files from memory and page cache by windows of this size in MB (0 keeps them)")
+        ("prefetch", po::value< u_int >(&prefetch)->default_value(0), "Read N blocks of the current file and a few next files ahead in background (0 disables)")
+        ("inflate-engine", po::value< std::string >(&inflateEngine)->default_value("zlib"), "Decompressor of deflate blocks: zlib, or fast which inflates a block at once")
+        ("inflate-window", po::value< u_int >(&inflateWindow)->default_value(0), "Inflate deflate blocks by parts while decoding records, at least this many KB ahead (0 inflates whole blocks first)")
+        ("build-index", po::bool_switch(&buildIndex), "Write block index next to input files (FILE.aqidx) instead of querying them")
+        ("build-stats", po::value< std::string >(&statsFields), "Write min/max and null counts of the fields per block next to input files (FILE.aqstats) instead of querying them")
+        ("build-bloom", po::value< std::string >(&bloomFields), "Write Bloom filters of the fields per block next to input files (FILE.aqbloom) instead of querying them")
+        ("seek-record", po::value< std::string >(&seekPosition), "Start each file from record N, or from record R of block B given as B:R")
+        ("print-position", po::bool_switch(&printPosition), "Prepend records with file name, block number and record number in the block")
+        ("follow", po::bool_switch(&follow), "Keep reading the last input file as it grows, like tail -f")
         ("count-only", po::bool_switch(&countMode), "Count of matched records, don't print them")
         ("record-separator", po::value<std::string>(&recordSeparator)->default_value("\\n"), "Record separator (\\n by default)")
         ("field-separator", po::value<std::string>(&fieldSeparator)->default_value("\\t"), "Field separator for TSV output (\\t by default)")
@@ -121,6 +191,11 @@ int main(int argc, const char * argv[]) {
         return 1;
     }
 
+    if (!statsFields.empty() && !bloomFields.empty()) {
+        std::cout << "arguments --build-stats and --build-bloom should not be set simultaneously"<< std::endl;
+        return 1;
+    }
+
     updateSeparator(recordSeparator);
     updateSeparator(fieldSeparator);
 
@@ -137,11 +212,19 @@ int main(int argc, const char * argv[]) {
         }
     }
 
+    std::vector<std::string> fileList;
     if (vm.count("input-file")) {
+        fileList = vm["input-file"].as< std::vector<std::string> >();
+    } else if (!isatty(STDIN_FILENO)) {
+        fileList.push_back("-");
+    }
+
+    if (!fileList.empty()) {
 
-        const auto &fileList = vm["input-file"].as< std::vector<std::string> >();
+        correctJobsNumber(walkJobs);
+        FileList files(fileList, walkJobs);
 
-        FileEmitor emitor(fileList, limit, outDocument);
+        FileEmitor emitor(files, limit, outDocument);
 
         emitor.setFilter(filter);
         emitor.setTsvFieldList(fields, fieldSeparator);
@@ -151,6 +234,47 @@ int main(int argc, const char * argv[]) {
         if (countMode) {
             emitor.enableCountOnlyMode();
         }
+        correctJobsNumber(scanJobs);
+        correctJobsNumber(openJobs);
+        emitor.setOpenJobs(openJobs);
+        emitor.setScanJobs(scanJobs);
+        emitor.setMmapWindow(size_t(mmapWindow) * 1024 * 1024);
+        if (prefetch > 0) {
+            emitor.enablePrefetch(prefetch);
+        }
+        avro::codec::Options codecOptions;
+        if (!parseInflateEngine(inflateEngine, codecOptions)) {
+            std::cerr << "Bad --inflate-engine value: " << inflateEngine << std::endl;
+            return 1;
+        }
+        codecOptions.inflateWindow = size_t(inflateWindow) * 1024;
+        emitor.setCodecOptions(codecOptions);
+        if (buildIndex) {
+            emitor.enableBuildIndex();
+        }
+        if (!statsFields.empty()) {
+            emitor.enableBuildStats(statsFields);
+        }
+        if (!bloomFields.empty()) {
+            emitor.enableBuildBloom(bloomFields);
+        }
+        if (printPosition) {
+            emitor.enablePrintPosition();
+        }
+        if (follow) {
+            // records come rarely, don't keep them in the buffer
+            std::cout << std::unitbuf;
+            emitor.enableFollow();
+        }
+        if (!seekPosition.empty()) {
+            int64_t block = -1;
+            int64_t record = 0;
+            if (!parseSeekPosition(seekPosition, block, record)) {
+                std::cerr << "Bad --seek-record value: " << seekPosition << std::endl;
+                return 1;
+            }
+            emitor.seek(block, record);
+        }
         if ( ! disableParseLoop ) {
             emitor.enableParseLoop();
         }
@@ -161,12 +285,34 @@ int main(int argc, const char * argv[]) {
 
         correctJobsNumber(jobs);
 
+        const bool stages = inflateJobs > 0 || decodeJobs > 0;
+        if (stages) {
+            // one of them given: a thread for the other stage
+            inflateJobs = std::max<u_int>(inflateJobs, 1);
+            decodeJobs = std::max<u_int>(decodeJobs, 1);
+            correctJobsNumber(inflateJobs);
+            correctJobsNumber(decodeJobs);
+            emitor.enableStages(inflateJobs, decodeJobs, balanceJobs);
+        }
+
+        if (splitBlocks > 0) {
+            emitor.enableSplitBlocks(splitBlocks);
+        }
+
         std::thread emitorThread([&emitor](){ emitor(); });
 
-        for(u_int i = 0; i < jobs; ++i) { // TODO: check for inadequate values
-            workers.emplace_back(
-                    std::thread(Worker(emitor))
-                );
+        if (stages) {
+            for(u_int i = 0; i < inflateJobs + decodeJobs; ++i) {
+                workers.emplace_back(
+                        std::thread(Worker(emitor, i))
+                    );
+            }
+        } else {
+            for(u_int i = 0; i < jobs; ++i) { // TODO: check for inadequate values
+                workers.emplace_back(
+                        std::thread(Worker(emitor))
+                    );
+            }
         }
 
         for(auto &p : workers) {
@@ -175,6 +321,13 @@ int main(int argc, const char * argv[]) {
 
         emitorThread.join();
 
+        try {
+            emitor.saveSidecars();
+        } catch (const std::runtime_error &e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+
         if (countMode) {
             std::cout << "Matched documents: " << emitor.getCountedDocuments() << std::endl;
         }
@@ -2,6 +2,7 @@
 #define __util_conqurrentqueue_
 
 #include <atomic>
+#include <chrono>
 #include <queue>
 #include <mutex>
 #include <condition_variable>
@@ -61,6 +62,43 @@ public:
 		return true;
 	}
 
+	// as pop(), but gives up after `timeout', check finished() then
+	bool pop_for(T &v, std::chrono::milliseconds timeout) {
+		std::unique_lock<std::mutex> lock(m);
+
+		if (!empty.wait_for(lock, timeout, [this]() { return !queue.empty() || is_done; })) {
+			return false;
+		}
+
+		if (queue.empty()) {
+			return false;
+		}
+
+		v = queue.front();
+		queue.pop();
+
+	    assert(v.get());
+
+		full.notify_one();
+
+		return true;
+	}
+
+	// done() is called and everything is popped
+	bool finished() {
+		std::unique_lock<std::mutex> lock(m);
+
+		return is_done && queue.empty();
+	}
+
+	void clear() {
+		std::unique_lock<std::mutex> lock(m);
+
+		std::queue<T>().swap(queue);
+
+		full.notify_all();
+	}
+
 	void done() {
 		std::unique_lock<std::mutex> lock(m);
 
@@ -0,0 +1,40 @@
+#ifndef __util_defaultinitallocator_
+#define __util_defaultinitallocator_
+
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace util {
+
+/*
+ * Allocator which default-initializes elements instead of value-initializing
+ * them: vector<uint8_t>::resize() of a buffer which is going to be
+ * overwritten anyway doesn't zero memory.
+ */
+template <typename T, typename A = std::allocator<T>>
+class default_init_allocator : public A {
+    using traits = std::allocator_traits<A>;
+public:
+    template <typename U>
+    struct rebind {
+        using other = default_init_allocator<U, typename traits::template rebind_alloc<U>>;
+    };
+
+    using A::A;
+
+    template <typename U>
+    void construct(U *ptr) noexcept(std::is_nothrow_default_constructible<U>::value) {
+        ::new(static_cast<void *>(ptr)) U;
+    }
+
+    template <typename U, typename... Args>
+    void construct(U *ptr, Args&&... args) {
+        traits::construct(static_cast<A &>(*this), ptr, std::forward<Args>(args)...);
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef __util_memsearch_
+#define __util_memsearch_
+
+#include <cstddef>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace util {
+
+/*
+ * memmem() replacement. SSE2 version compares first and last bytes of the
+ * needle against 16 positions at once and runs memcmp only for candidates.
+ */
+inline
+const char *memsearch(const char *haystack, size_t n, const char *needle, size_t m) {
+    if (m == 0) {
+        return haystack;
+    }
+    if (n < m) {
+        return nullptr;
+    }
+
+    size_t i = 0;
+#ifdef __SSE2__
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[m - 1]);
+
+    for (; i + m - 1 + 16 <= n; i += 16) {
+        const __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + i));
+        const __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + i + m - 1));
+
+        unsigned mask = _mm_movemask_epi8(
+            _mm_and_si128(
+                _mm_cmpeq_epi8(blockFirst, first),
+                _mm_cmpeq_epi8(blockLast, last)
+            )
+        );
+
+        while (mask != 0) {
+            const char *candidate = haystack + i + __builtin_ctz(mask);
+            if (std::memcmp(candidate, needle, m) == 0) {
+                return candidate;
+            }
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; i + m <= n; ++i) {
+        if (haystack[i] == needle[0] && std::memcmp(haystack + i, needle, m) == 0) {
+            return haystack + i;
+        }
+    }
+    return nullptr;
+}
+
+}
+
+#endif
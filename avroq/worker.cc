@@ -1,3 +1,4 @@
+#include <chrono>
 #include <memory>
 #include <iostream>
 
@@ -7,11 +8,15 @@
 #include <avro/finished.h>
 
 #include <avro/codec/create.h>
+#include <avro/sidecar/bloom.h>
+#include <avro/sidecar/stats.h>
 
 #include <filter/filter.h>
 #include <filter/equality_expression.h>
 #include <filter/record_expression.h>
 
+#include <util/onscopeexit.h>
+
 #include "fileemitor.h"
 
 #include "worker.h"
@@ -21,33 +26,127 @@ Worker::Worker(FileEmitor &emitor) : emitor(emitor) {
 
 }
 
+Worker::Worker(FileEmitor &emitor, size_t stageThread)
+    : emitor(emitor),
+      staged(true),
+      stageThread(stageThread) {
+}
+
+namespace {
+    uint64_t nanosecondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start
+            ).count();
+    }
+}
+
 void Worker::operator()() {
 
     avro::Block block;
     std::unique_ptr<avro::BlockDecoder> decoder;
     size_t fileId = -1;
 
-    std::vector<uint8_t> storage;
-    storage.resize(4 * 1024 * 1024);
+    // codecs keep their state from block to block
+    std::shared_ptr<avro::codec::Codec> codec;
+    std::string codecName;
+    auto codecFor = [&codec, &codecName, this](const avro::header &header) -> avro::codec::Codec & {
+        if (!codec || avro::codec::codecName(header) != codecName) {
+            codec = avro::codec::createForHeader(header, emitor.getCodecOptions());
+            codecName = avro::codec::codecName(header);
+        }
+        return *codec;
+    };
+
+    // staged threads inflate into storage of the task
+    avro::codec::storage_t storage;
+    if (!staged) {
+        storage.resize(4 * 1024 * 1024);
+    }
 
     while (true) {
 
         try {
 
+            if (staged && emitor.isInflateThread(stageThread)) {
+                std::shared_ptr<Task> task;
+                if (!emitor.getNextToInflate(task)) {
+                    if (emitor.isInflatingDone()) {
+                        break;
+                    }
+                    continue;
+                }
+                const auto start = std::chrono::steady_clock::now();
+
+                // parts of split blocks come inflated by the emitor
+                if (task->inflated) {
+                    emitor.inflated(task, 0);
+                    continue;
+                }
+                try {
+                    task->storage = emitor.getStorage();
+                    task->inflated = std::make_shared<avro::StringBuffer>(
+                            codecFor(*task->header).decode(*task->buffer, *task->storage)
+                        );
+                } catch (...) {
+                    emitor.inflateFailed(task);
+                    throw;
+                }
+
+                emitor.inflated(task, nanosecondsSince(start));
+                continue;
+            }
+
             auto task = emitor.getNextTask(decoder, fileId);
 
             if (!task) {
+                if (staged && !emitor.isDecodingDone()) {
+                    continue;
+                }
                 break;
             }
+            const auto start = std::chrono::steady_clock::now();
+
+            // storage of the block goes back to the pool even if it fails
+            util::on_scope_exit settle([this, &task, start]() {
+                if (staged) {
+                    emitor.decoded(task, nanosecondsSince(start));
+                }
+            });
+
+            const size_t inflateWindow = emitor.getCodecOptions().inflateWindow;
+            if (task->inflated) {
+                block.buffer.assignData(*task->inflated);
+            } else if (inflateWindow > 0 && !task->statsBuild && !task->bloomBuild &&
+                    codecFor(*task->header).startStream(*task->buffer)) {
+                // records are decoded as soon as the first window is inflated
+                block.buffer.assignStream(
+                    [&codec](char *to, size_t len) {
+                        return codec->decodeSome(reinterpret_cast<uint8_t *>(to), len);
+                    },
+                    storage, inflateWindow);
+            } else {
+                auto data = codecFor(*task->header).decode(*task->buffer, storage);
+
+                block.buffer.assignData(data);
+            }
 
-            auto codec = avro::codec::createForHeader(*task->header);
-
-            auto data = codec->decode(*task->buffer, storage);
-
-            block.buffer.assignData(data);
             block.objectCount = task->objectCount;
-
-            decoder->decodeAndDumpBlock(block);
+            block.skipObjects = task->skipObjects;
+            block.number = task->blockNumber;
+            block.firstRecord = task->firstRecord;
+            block.fileName = &task->currentFileName;
+
+            if (task->statsBuild) {
+                avro::sidecar::BlockStats stats;
+                decoder->collectStats(block, stats);
+                task->statsBuild->setBlock(task->blockNumber, std::move(stats));
+            } else if (task->bloomBuild) {
+                avro::sidecar::BlockBloom bloom;
+                decoder->collectBloom(block, bloom);
+                task->bloomBuild->setBlock(task->blockNumber, std::move(bloom));
+            } else {
+                decoder->decodeAndDumpBlock(block);
+            }
 
         } catch (const avro::Eof &e) {
             ; // reading done
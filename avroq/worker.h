@@ -1,16 +1,22 @@
 #ifndef _worker_h
 #define _worker_h
 
+#include <cstddef>
+
 class FileEmitor;
 
 class Worker {
 public:
     explicit Worker(FileEmitor &emitor);
+    // thread number `stageThread' of FileEmitor::enableStages
+    Worker(FileEmitor &emitor, size_t stageThread);
 
     void operator()();
     
 private:
     FileEmitor &emitor;
+    bool staged = false;
+    size_t stageThread = 0;
 };
 
 #endif
\ No newline at end of file
@@ -10,7 +10,7 @@ _aq_complete() {
     -*)
 	    COMPREPLY=( $( compgen -W '-f -l -j -n -h --condition --limit \
 				    --input-file --fields --print-file --help --version \
-				    --jobs --count-only --record-separator --field-separator \
+				    --jobs --inflate-jobs --decode-jobs --balance-jobs --split-blocks --walk-jobs --open-jobs --scan-jobs --mmap-window --prefetch --inflate-engine --inflate-window --build-index --build-stats --build-bloom --seek-record --print-position --follow --count-only --record-separator --field-separator \
 				    --disable-parse-loop' -- $cur ) )
 	    return 0
 	    ;;